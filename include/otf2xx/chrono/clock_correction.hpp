@@ -0,0 +1,186 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_CHRONO_CLOCK_CORRECTION_HPP
+#define INCLUDE_OTF2XX_CHRONO_CLOCK_CORRECTION_HPP
+
+#include <otf2xx/chrono/ticks.hpp>
+#include <otf2xx/exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace otf2
+{
+namespace chrono
+{
+
+    /**
+     * \brief a piecewise linear correction of the ticks of a local clock
+     *
+     * The correction maps the ticks of a local clock to the ticks of the global clock of the
+     * trace. It is made of segments, each starting at a tick of the local clock with an offset to
+     * the global clock and the drift of the local clock, i.e. the change of the offset per tick.
+     *
+     * A default constructed correction doesn't change anything.
+     *
+     * \note The correction remembers the segment it used last, so it must not be used by several
+     *       threads at once.
+     */
+    class clock_correction
+    {
+        struct segment
+        {
+            std::uint64_t begin;
+            double offset;
+            double drift;
+        };
+
+    public:
+        clock_correction() = default;
+
+        /**
+         * \brief creates a linear correction
+         *
+         * \param[in] offset the offset at the reference tick
+         * \param[in] drift the change of the offset per tick
+         * \param[in] reference the tick of the local clock, where the offset was measured
+         */
+        static clock_correction linear(std::int64_t offset, double drift = 0,
+                                       otf2::chrono::ticks reference = otf2::chrono::ticks(0))
+        {
+            clock_correction result;
+
+            result.segments_.push_back(
+                segment{ reference.count(), static_cast<double>(offset), drift });
+
+            return result;
+        }
+
+        /**
+         * \brief adds a synchronization point between the local and the global clock
+         *
+         * Between two synchronization points, the offset is interpolated linearly. Before the
+         * first and after the last one, the closest segment is extrapolated. With a single
+         * synchronization point, the correction is a constant offset.
+         *
+         * Synchronization points have to be added in increasing order of the local ticks.
+         */
+        void add_sync_point(otf2::chrono::ticks local, otf2::chrono::ticks global)
+        {
+            auto offset = static_cast<double>(global.count()) - static_cast<double>(local.count());
+
+            if (segments_.empty())
+            {
+                segments_.push_back(segment{ local.count(), offset, 0 });
+                return;
+            }
+
+            auto& last = segments_.back();
+
+            if (local.count() <= last.begin)
+            {
+                make_exception("Synchronization points have to be added in increasing order");
+            }
+
+            last.drift = (offset - last.offset) / static_cast<double>(local.count() - last.begin);
+
+            segments_.push_back(segment{ local.count(), offset, last.drift });
+        }
+
+        /**
+         * \brief returns if the correction changes any tick
+         */
+        bool empty() const
+        {
+            return segments_.empty();
+        }
+
+        /**
+         * \brief corrects the given ticks of the local clock
+         */
+        otf2::chrono::ticks operator()(otf2::chrono::ticks local) const
+        {
+            if (segments_.empty())
+            {
+                return local;
+            }
+
+            const auto& s = find(local.count());
+
+            auto distance = static_cast<double>(static_cast<std::int64_t>(local.count() - s.begin));
+            auto offset = static_cast<std::int64_t>(std::llround(s.offset + s.drift * distance));
+
+            if (offset < 0 && static_cast<std::uint64_t>(-offset) > local.count())
+            {
+                make_exception("The correction of the tick ", local.count(),
+                               " is before the epoch of the clock");
+            }
+
+            return otf2::chrono::ticks(local.count() + static_cast<std::uint64_t>(offset));
+        }
+
+    private:
+        const segment& find(std::uint64_t local) const
+        {
+            // the events of a location are ordered by time, so it's most likely the same segment
+            // as for the last tick
+            const auto& hint = segments_[hint_];
+            if (hint.begin <= local &&
+                (hint_ + 1 == segments_.size() || local < segments_[hint_ + 1].begin))
+            {
+                return hint;
+            }
+
+            auto it = std::upper_bound(
+                segments_.begin(), segments_.end(), local,
+                [](std::uint64_t value, const segment& seg) { return value < seg.begin; });
+
+            // ticks before the first segment are extrapolated from the first one
+            hint_ = it == segments_.begin() ? 0 : std::distance(segments_.begin(), it) - 1;
+
+            return segments_[hint_];
+        }
+
+    private:
+        std::vector<segment> segments_;
+        mutable std::size_t hint_ = 0;
+    };
+} // namespace chrono
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_CHRONO_CLOCK_CORRECTION_HPP
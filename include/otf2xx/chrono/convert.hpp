@@ -44,12 +44,65 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 
 namespace otf2
 {
 namespace chrono
 {
+    namespace detail
+    {
+        /**
+         * \brief exact unsigned integer division by a divisor, which is fixed at runtime
+         *
+         * The division is done as a multiplication with the precomputed reciprocal of the
+         * divisor. As the reciprocal is rounded down, the estimated quotient is too small by at
+         * most one, which is corrected with the remainder.
+         */
+        class divider
+        {
+        public:
+            explicit divider(std::uint64_t divisor = 1)
+            : divisor_(divisor), reciprocal_(std::numeric_limits<std::uint64_t>::max() / divisor)
+            {
+                assert(divisor != 0);
+            }
+
+            std::uint64_t divisor() const
+            {
+                return divisor_;
+            }
+
+            std::uint64_t operator()(std::uint64_t n) const
+            {
+                auto q = static_cast<std::uint64_t>(
+                    (static_cast<uint128_t>(n) * reciprocal_) >> 64);
+
+                // without a branch, so loops over it stay free of branches too
+                q += (n - q * divisor_ >= divisor_) ? 1 : 0;
+
+                return q;
+            }
+
+            /**
+             * \brief divides n by the divisor and rounds up
+             */
+            std::uint64_t ceil(std::uint64_t n) const
+            {
+                auto q = (*this)(n);
+
+                return q * divisor_ == n ? q : q + 1;
+            }
+
+        private:
+            __extension__ typedef unsigned __int128 uint128_t;
+
+            std::uint64_t divisor_;
+            std::uint64_t reciprocal_;
+        };
+    } // namespace detail
 
     /**
      * \brief class to convert between ticks and time points
@@ -57,6 +110,9 @@ namespace chrono
      * This class can convert between ticks and time points.
      * For this, it needs the number of ticks per second.
      *
+     * If the number of ticks per second divides or is divided by the resolution of the clock,
+     * the conversion is done exactly with integers. Otherwise, it uses floating point math.
+     *
      * \note The time epoch is assumed to be equal between the time point and
      *       time point represented with the number ticks given.
      */
@@ -70,8 +126,35 @@ namespace chrono
                          otf2::chrono::ticks offset = otf2::chrono::ticks(0))
         : offset_(offset.count()),
           factor_(static_cast<double>(clock::period::den) / ticks_per_second.count()),
-          inverse_factor_(ticks_per_second.count() / static_cast<double>(clock::period::den))
+          inverse_factor_(ticks_per_second.count() / static_cast<double>(clock::period::den)),
+          scaling_(scaling::floating)
         {
+            auto den = static_cast<uint64_t>(clock::period::den);
+            auto tps = ticks_per_second.count();
+
+            // zero ticks per second stay with the floating point math, like before the integer
+            // paths existed
+            if (tps == 0)
+            {
+                return;
+            }
+
+            if (tps == den)
+            {
+                scaling_ = scaling::identity;
+            }
+            else if (den % tps == 0)
+            {
+                // every tick is a whole number of clock periods
+                scaling_ = scaling::multiply;
+                ratio_ = detail::divider(den / tps);
+            }
+            else if (tps % den == 0)
+            {
+                // every clock period is a whole number of ticks
+                scaling_ = scaling::divide;
+                ratio_ = detail::divider(tps / den);
+            }
         }
 
         explicit convert(const otf2::definition::clock_properties& cp)
@@ -106,6 +189,14 @@ namespace chrono
         convert(convert&&) = default;
         convert& operator=(convert&&) = default;
 
+        /**
+         * \brief returns the ticks, which are converted to the epoch of the time points
+         */
+        otf2::chrono::ticks offset() const
+        {
+            return otf2::chrono::ticks(offset_);
+        }
+
         /**
          * \brief converts from ticks to time point
          *
@@ -121,6 +212,25 @@ namespace chrono
 
             auto tp = ticks.count() - offset_;
 
+            switch (scaling_)
+            {
+            case scaling::identity:
+                return time_point(otf2::chrono::duration(static_cast<int64_t>(tp)));
+
+            case scaling::multiply:
+                assert(tp <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) /
+                                 ratio_.divisor());
+
+                return time_point(
+                    otf2::chrono::duration(static_cast<int64_t>(tp * ratio_.divisor())));
+
+            case scaling::divide:
+                return time_point(otf2::chrono::duration(static_cast<int64_t>(ratio_(tp))));
+
+            case scaling::floating:
+                break;
+            }
+
             assert(tp <=
                    static_cast<uint64_t>(static_cast<double>(std::numeric_limits<int64_t>::max())) /
                        factor_);
@@ -139,6 +249,27 @@ namespace chrono
         {
             auto tp = static_cast<uint64_t>(t.time_since_epoch().count());
 
+            switch (scaling_)
+            {
+            case scaling::identity:
+                assert(tp <= std::numeric_limits<std::uint64_t>::max() - offset_);
+
+                return ticks(tp + offset_);
+
+            case scaling::multiply:
+                // round up, like the floating point conversion below
+                return ticks(ratio_.ceil(tp) + offset_);
+
+            case scaling::divide:
+                assert(tp <= (std::numeric_limits<std::uint64_t>::max() - offset_) /
+                                 ratio_.divisor());
+
+                return ticks(tp * ratio_.divisor() + offset_);
+
+            case scaling::floating:
+                break;
+            }
+
             assert(tp <
                    static_cast<uint64_t>(static_cast<double>(std::numeric_limits<int64_t>::max())) /
                        inverse_factor_);
@@ -156,11 +287,186 @@ namespace chrono
             return ticks(tpi + offset_);
         }
 
+        /**
+         * \brief converts a batch of ticks to time points
+         *
+         * The results are the same as converting every element on its own. But the kind of
+         * scaling is chosen and the preconditions are checked once for the batch, so the loops
+         * have no branches. The compiler can vectorize the identity and multiply loops, and the
+         * floating point loops, if the target converts 64 bit integers to double, e.g. with
+         * AVX-512DQ. The exact division by the ratio needs a 128 bit multiplication and stays
+         * scalar.
+         *
+         * \param[in] in the ticks to convert
+         * \param[out] out the time points, must have room for count elements
+         * \param[in] count number of elements
+         */
+        void operator()(const otf2::chrono::ticks* in, otf2::chrono::time_point* out,
+                        std::size_t count) const
+        {
+            check_batch(in, count);
+
+            const auto offset = offset_;
+
+            switch (scaling_)
+            {
+            case scaling::identity:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    out[i] = time_point(
+                        otf2::chrono::duration(static_cast<int64_t>(in[i].count() - offset)));
+                }
+                break;
+
+            case scaling::multiply:
+            {
+                const auto ratio = ratio_.divisor();
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    out[i] = time_point(otf2::chrono::duration(
+                        static_cast<int64_t>((in[i].count() - offset) * ratio)));
+                }
+                break;
+            }
+
+            case scaling::divide:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    out[i] = time_point(otf2::chrono::duration(
+                        static_cast<int64_t>(ratio_(in[i].count() - offset))));
+                }
+                break;
+
+            case scaling::floating:
+            {
+                // check_batch() ensures, that the ticks fit into int64_t, whose conversion to
+                // double doesn't need the branches of the one from uint64_t
+                const auto factor = factor_;
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    out[i] = time_point(otf2::chrono::duration(static_cast<int64_t>(
+                        static_cast<double>(static_cast<int64_t>(in[i].count() - offset)) *
+                        factor)));
+                }
+                break;
+            }
+            }
+        }
+
+        /**
+         * \brief converts a batch of time points to ticks
+         *
+         * \see operator()(const otf2::chrono::ticks*, otf2::chrono::time_point*, std::size_t)
+         */
+        void operator()(const otf2::chrono::time_point* in, otf2::chrono::ticks* out,
+                        std::size_t count) const
+        {
+            check_batch(in, count);
+
+            const auto offset = offset_;
+
+            switch (scaling_)
+            {
+            case scaling::identity:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    out[i] =
+                        ticks(static_cast<uint64_t>(in[i].time_since_epoch().count()) + offset);
+                }
+                break;
+
+            case scaling::multiply:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    out[i] = ticks(
+                        ratio_.ceil(static_cast<uint64_t>(in[i].time_since_epoch().count())) +
+                        offset);
+                }
+                break;
+
+            case scaling::divide:
+            {
+                const auto ratio = ratio_.divisor();
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    out[i] = ticks(static_cast<uint64_t>(in[i].time_since_epoch().count()) * ratio +
+                                   offset);
+                }
+                break;
+            }
+
+            case scaling::floating:
+            {
+                // as above, only signed conversions between integers and double. The values are
+                // not negative, so the truncation rounds down and std::ceil() is done by adding
+                // one for a remaining fraction, which unlike the library call can be vectorized.
+                const auto inverse_factor = inverse_factor_;
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    auto tp =
+                        static_cast<double>(in[i].time_since_epoch().count()) * inverse_factor;
+                    auto tpi = static_cast<int64_t>(tp);
+                    tpi += static_cast<double>(tpi) < tp ? 1 : 0;
+
+                    out[i] = ticks(static_cast<uint64_t>(tpi) + offset);
+                }
+                break;
+            }
+            }
+        }
+
     private:
+        /**
+         * \brief asserts the preconditions of a batch conversion from ticks
+         *
+         * The same as for the conversion of every single element, but outside of the loops, which
+         * do the conversion.
+         */
+        void check_batch(const otf2::chrono::ticks* in, std::size_t count) const
+        {
+#ifndef NDEBUG
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                (*this)(in[i]);
+            }
+#else
+            (void)in;
+            (void)count;
+#endif
+        }
+
+        /**
+         * \brief asserts the preconditions of a batch conversion from time points
+         */
+        void check_batch(const otf2::chrono::time_point* in, std::size_t count) const
+        {
+#ifndef NDEBUG
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                assert(in[i].time_since_epoch().count() >= 0);
+                (*this)(in[i]);
+            }
+#else
+            (void)in;
+            (void)count;
+#endif
+        }
+
         uint64_t offset_;
 
         double factor_;
         double inverse_factor_;
+
+        enum class scaling
+        {
+            identity,
+            multiply,
+            divide,
+            floating
+        };
+
+        scaling scaling_;
+        detail::divider ratio_;
     };
 
     /**
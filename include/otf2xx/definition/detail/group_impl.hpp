@@ -36,6 +36,8 @@
 #define INCLUDE_OTF2XX_DEFINITIONS_DETAIL_GROUP_HPP
 
 #include <otf2xx/common.hpp>
+#include <otf2xx/exception.hpp>
+#include <otf2xx/intrusive_ptr.hpp>
 #include <otf2xx/definition/fwd.hpp>
 
 #include <otf2xx/definition/detail/ref_counted.hpp>
@@ -44,7 +46,8 @@
 
 #include <otf2xx/traits/definition.hpp>
 
-#include <memory>
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 namespace otf2
@@ -53,6 +56,24 @@ namespace definition
 {
     namespace detail
     {
+        /**
+         * \brief owning pointer to the impl of a group member
+         *
+         * This indirection allows groups of still incomplete definition types.
+         */
+        template <class MemberType>
+        struct group_member_impl
+        {
+            otf2::intrusive_ptr<typename MemberType::impl_type> ptr;
+        };
+
+        /**
+         * \brief impl of group definitions
+         *
+         * The reference numbers of the members are stored contiguously, next to the owning
+         * pointers to their impl objects. Member handles are only created on access, and a hash
+         * index maps each reference number to its position in the group.
+         */
         template <class MemberType,
                   otf2::common::group_type GroupType = otf2::common::group_type::unknown>
         class group_impl : public ref_counted
@@ -60,8 +81,6 @@ namespace definition
             static_assert(otf2::traits::is_definition<MemberType>::value,
                           "The MemberType has to be a otf2::definition.");
 
-            typedef std::vector<MemberType> members_type;
-
         public:
             typedef otf2::common::group_type group_type;
             typedef otf2::common::group_flag_type group_flag_type;
@@ -97,56 +116,90 @@ namespace definition
                 return group_flag_;
             }
 
-            std::vector<std::uint64_t> members() const
+            const std::vector<std::uint64_t>& members() const
             {
-                std::vector<std::uint64_t> result(members_.size());
+                return refs_;
+            }
 
-                for (std::size_t i = 0; i < members_.size(); i++)
-                {
-                    result[i] = members_[i].ref();
-                }
+            std::size_t size() const
+            {
+                return refs_.size();
+            }
 
-                return result;
+            value_type operator[](std::size_t i) const
+            {
+                using reference_type = typename value_type::reference_type;
+                return value_type(reference_type(refs_[i]), impls_[i].ptr.get());
             }
 
-            std::size_t size() const
+            bool contains(std::uint64_t ref) const
             {
-                return members_.size();
+                return index_.count(ref) != 0;
             }
 
-            const value_type& operator[](std::size_t i) const
+            std::size_t index_of(std::uint64_t ref) const
             {
-                return members_[i];
+                auto it = index_.find(ref);
+
+                if (it == index_.end())
+                {
+                    make_exception("The definition #", ref, " isn't a member of the group");
+                }
+
+                return it->second;
             }
 
-            void add_member(value_type&& member)
+            void reserve(std::size_t size)
             {
-                members_.emplace_back(std::forward(member));
+                refs_.reserve(size);
+                impls_.reserve(size);
+                index_.reserve(size);
             }
 
             void add_member(const value_type& member)
             {
-                members_.push_back(member);
+                // duplicates keep the position of their first occurrence
+                index_.emplace(member.ref(), refs_.size());
+                refs_.push_back(member.ref());
+                impls_.push_back({ otf2::intrusive_ptr<typename value_type::impl_type>(member.get()) });
             }
 
             void remove_member(const value_type& def)
             {
-                for (auto it = members_.begin(); it != members_.end();)
+                std::uint64_t ref = def.ref();
+
+                if (index_.erase(ref) == 0)
                 {
-                    if (it->ref() == def.ref())
-                    {
-                        it = members_.erase(it);
-                    }
-                    else
+                    return;
+                }
+
+                std::size_t j = 0;
+                for (std::size_t i = 0; i < refs_.size(); ++i)
+                {
+                    if (refs_[i] != ref)
                     {
-                        ++it;
+                        refs_[j] = refs_[i];
+                        impls_[j] = std::move(impls_[i]);
+                        ++j;
                     }
                 }
+
+                refs_.resize(j);
+                impls_.resize(j);
+
+                // positions behind the removed member have changed
+                index_.clear();
+                for (std::size_t i = 0; i < refs_.size(); ++i)
+                {
+                    index_.emplace(refs_[i], i);
+                }
             }
 
         private:
             otf2::definition::string name_;
-            members_type members_;
+            std::vector<std::uint64_t> refs_;
+            std::vector<group_member_impl<MemberType>> impls_;
+            std::unordered_map<std::uint64_t, std::size_t> index_;
             paradigm_type paradigm_;
             group_flag_type group_flag_;
         };
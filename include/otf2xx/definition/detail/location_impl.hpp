@@ -96,6 +96,11 @@ namespace definition
                 ++events_;
             }
 
+            void events_written(std::uint64_t count)
+            {
+                events_ += count;
+            }
+
             friend class writer::local;
 
         private:
@@ -112,6 +112,12 @@ namespace definition
                 return id_map_.get();
             }
 
+            void add(std::uint64_t local_id, std::uint64_t global_id)
+            {
+                check(OTF2_IdMap_AddIdPair(id_map_.get(), local_id, global_id),
+                      "Couldn't add an id pair to the IdMap");
+            }
+
         private:
             struct OTF2_IdMap_deleter
             {
@@ -35,7 +35,10 @@
 #ifndef INCLUDE_OTF2XX_DEFINITIONS_REF_COUNTED_HPP
 #define INCLUDE_OTF2XX_DEFINITIONS_REF_COUNTED_HPP
 
+#include <otf2xx/definition/detail/slab_pool.hpp>
+
 #include <atomic>
+#include <cstdint>
 
 namespace otf2
 {
@@ -45,36 +48,129 @@ namespace definition
 {
     namespace detail
     {
+        /**
+         * \brief thread-safe reference count, used by default
+         */
+        class atomic_ref_count
+        {
+        public:
+            explicit atomic_ref_count(int64_t count) : count_(count)
+            {
+            }
+
+            void increment()
+            {
+                count_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            int64_t decrement()
+            {
+                // fetch_sub() returns the old value, preceeding the operation.
+                // Thus, we have to subtract one from the return value.
+                return count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+            }
+
+            int64_t get() const
+            {
+                return count_.load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<int64_t> count_;
+        };
+
+        /**
+         * \brief reference count without any synchronization
+         *
+         * Selected with OTF2XX_NON_ATOMIC_REFCOUNT. Only use this, if definitions are never
+         * shared between threads. The async writer, the threaded run() of the rewriter, merger and
+         * splitter, and an archive shared between threads all share definitions.
+         */
+        class plain_ref_count
+        {
+        public:
+            explicit plain_ref_count(int64_t count) : count_(count)
+            {
+            }
+
+            void increment()
+            {
+                ++count_;
+            }
+
+            int64_t decrement()
+            {
+                return --count_;
+            }
+
+            int64_t get() const
+            {
+                return count_;
+            }
+
+        private:
+            int64_t count_;
+        };
+
+#ifdef OTF2XX_NON_ATOMIC_REFCOUNT
+        using ref_count = plain_ref_count;
+#else
+        using ref_count = atomic_ref_count;
+#endif
+
         class ref_counted
         {
         public:
-            ref_counted(int64_t retain_count = 0) : ref_count_(retain_count)
+            ref_counted(int64_t retain_count = 0)
+            : ref_count_(retain_count | (claim_slab_object(this) ? in_slab : 0))
             {
             }
 
+            ~ref_counted()
+            {
+                destroyed_slab_object() = (ref_count_.get() & in_slab) != 0;
+            }
+
             ref_counted(const ref_counted&) = delete;
             ref_counted& operator=(const ref_counted&) = delete;
 
             ref_counted(ref_counted&&) = delete;
             ref_counted& operator=(ref_counted&&) = delete;
 
+            /**
+             * \brief allocates impl objects, either from the heap or from the slab_pool of an
+             * active slab_scope
+             *
+             * Objects on the heap are plain allocations. Objects in a slab are marked with a bit
+             * of their reference count, which is read on their destruction.
+             */
+            static void* operator new(std::size_t size)
+            {
+                return slab_allocate(size);
+            }
+
+            static void operator delete(void* ptr)
+            {
+                slab_deallocate(ptr);
+            }
+
         private:
             void retain()
             {
-                ref_count_.fetch_add(1, std::memory_order_relaxed);
+                ref_count_.increment();
             }
 
             int64_t release()
             {
-                // fetch_sub() returns the old value, preceeding the operation.
-                // Thus, we have to subtract one from the return value.
-                return ref_count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+                return ref_count_.decrement() & ~in_slab;
             }
 
+            static constexpr int64_t in_slab = int64_t(1) << 62;
+
             template <class T>
             friend class ::otf2::intrusive_ptr;
 
-            std::atomic<int64_t> ref_count_;
+            ref_count ref_count_;
         };
     } // namespace detail
 } // namespace definition
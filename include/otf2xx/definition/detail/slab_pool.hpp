@@ -0,0 +1,410 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_DEFINITIONS_DETAIL_SLAB_POOL_HPP
+#define INCLUDE_OTF2XX_DEFINITIONS_DETAIL_SLAB_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace otf2
+{
+namespace definition
+{
+    namespace detail
+    {
+        /**
+         * \brief lock for builds with OTF2XX_NON_ATOMIC_REFCOUNT, where definitions stay on one
+         * thread anyway
+         */
+        struct null_mutex
+        {
+            void lock()
+            {
+            }
+
+            void unlock()
+            {
+            }
+        };
+
+#ifdef OTF2XX_NON_ATOMIC_REFCOUNT
+        using slab_mutex = null_mutex;
+#else
+        using slab_mutex = std::mutex;
+#endif
+
+        /**
+         * \brief the memory behind a slab_pool
+         *
+         * Hands out fixed size slots carved from large slabs and recycles freed slots. The
+         * storage outlives its slab_pool as long as there are allocated slots left, so handles
+         * which outlive their registry stay valid.
+         *
+         * Slabs are aligned to their size and start with a pointer to their storage, so the
+         * storage of an object is found from its address alone. The objects themselves don't
+         * carry any header.
+         */
+        class slab_storage
+        {
+            struct free_slot
+            {
+                free_slot* next;
+            };
+
+            struct slab_header
+            {
+                slab_storage* storage;
+            };
+
+        public:
+            static constexpr std::size_t slab_bytes = 64 * 1024;
+
+            explicit slab_storage(std::size_t object_size)
+            : object_size_(object_size),
+              slot_size_(round_up(std::max(object_size, sizeof(free_slot)))),
+              slots_per_slab_((slab_bytes - round_up(sizeof(slab_header))) / slot_size_)
+            {
+                assert(slots_per_slab_ > 0);
+            }
+
+            slab_storage(const slab_storage&) = delete;
+            slab_storage& operator=(const slab_storage&) = delete;
+
+            ~slab_storage()
+            {
+                for (auto slab : slabs_)
+                {
+                    ::operator delete(slab, std::align_val_t(slab_bytes));
+                }
+            }
+
+            /**
+             * \brief returns the storage, which allocated the object
+             */
+            static slab_storage& owner(void* object)
+            {
+                auto address = reinterpret_cast<std::uintptr_t>(object);
+                auto slab = reinterpret_cast<slab_header*>(address & ~(slab_bytes - 1));
+
+                return *slab->storage;
+            }
+
+            std::size_t object_size() const
+            {
+                return object_size_;
+            }
+
+            void* allocate()
+            {
+                std::lock_guard<slab_mutex> lock(mutex_);
+
+                void* object;
+                if (free_ != nullptr)
+                {
+                    object = free_;
+                    free_ = free_->next;
+                }
+                else
+                {
+                    if (cursor_ == end_)
+                    {
+                        auto slab = static_cast<unsigned char*>(
+                            ::operator new(slab_bytes, std::align_val_t(slab_bytes)));
+                        reinterpret_cast<slab_header*>(slab)->storage = this;
+                        slabs_.push_back(slab);
+
+                        cursor_ = slab + round_up(sizeof(slab_header));
+                        end_ = cursor_ + slots_per_slab_ * slot_size_;
+                    }
+
+                    object = cursor_;
+                    cursor_ += slot_size_;
+                }
+
+                live_.fetch_add(1, std::memory_order_relaxed);
+                return object;
+            }
+
+            /**
+             * \brief returns the slot of the object
+             *
+             * Once the owning slab_pool is gone, the slot isn't recycled anymore, as nothing will
+             * be allocated from this storage again. The last object frees all slabs at once.
+             */
+            void deallocate(void* object)
+            {
+                if (!orphaned_.load(std::memory_order_relaxed))
+                {
+                    std::lock_guard<slab_mutex> lock(mutex_);
+
+                    auto slot = static_cast<free_slot*>(object);
+                    slot->next = free_;
+                    free_ = slot;
+                }
+
+                release();
+            }
+
+            /**
+             * \brief called by the owning slab_pool, when it goes away
+             *
+             * Frees all slabs in one go, if there are no objects left. Otherwise this is deferred
+             * until the last object got deallocated.
+             */
+            void orphan()
+            {
+                orphaned_.store(true, std::memory_order_relaxed);
+                release();
+            }
+
+            /**
+             * \brief returns the number of allocated objects, only valid before orphan()
+             */
+            std::size_t size() const
+            {
+                return live_.load(std::memory_order_relaxed) - 1;
+            }
+
+            std::size_t capacity() const
+            {
+                std::lock_guard<slab_mutex> lock(mutex_);
+                return slabs_.size() * slots_per_slab_;
+            }
+
+        private:
+            static std::size_t round_up(std::size_t size)
+            {
+                constexpr auto align = alignof(std::max_align_t);
+                return (size + align - 1) / align * align;
+            }
+
+            void release()
+            {
+                if (live_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    delete this;
+                }
+            }
+
+        private:
+            mutable slab_mutex mutex_;
+
+            std::size_t object_size_;
+            std::size_t slot_size_;
+            std::size_t slots_per_slab_;
+
+            std::vector<unsigned char*> slabs_;
+            unsigned char* cursor_ = nullptr;
+            unsigned char* end_ = nullptr;
+            free_slot* free_ = nullptr;
+
+            // the allocated objects, plus one for the owning slab_pool
+            std::atomic<std::size_t> live_{ 1 };
+            std::atomic<bool> orphaned_{ false };
+        };
+
+        /**
+         * \brief a pool for objects of one definition impl type
+         *
+         * Use a slab_scope to direct the allocations of ref_counted objects into this pool.
+         */
+        class slab_pool
+        {
+        public:
+            explicit slab_pool(std::size_t object_size) : storage_(new slab_storage(object_size))
+            {
+            }
+
+            slab_pool(const slab_pool&) = delete;
+            slab_pool& operator=(const slab_pool&) = delete;
+
+            ~slab_pool()
+            {
+                storage_->orphan();
+            }
+
+            slab_storage& storage()
+            {
+                return *storage_;
+            }
+
+            /**
+             * \brief returns the number of objects currently living in this pool
+             */
+            std::size_t size() const
+            {
+                return storage_->size();
+            }
+
+            /**
+             * \brief returns the number of slots in all slabs allocated so far
+             */
+            std::size_t capacity() const
+            {
+                return storage_->capacity();
+            }
+
+        private:
+            slab_storage* storage_;
+        };
+
+        inline slab_storage*& active_slab_storage()
+        {
+            static thread_local slab_storage* storage = nullptr;
+            return storage;
+        }
+
+        /**
+         * \brief the object allocated from a slab by the current thread, which isn't constructed
+         * yet
+         */
+        struct pending_slab_object
+        {
+            void* object = nullptr;
+            std::size_t size = 0;
+        };
+
+        inline pending_slab_object& pending_slab_allocation()
+        {
+            static thread_local pending_slab_object pending;
+            return pending;
+        }
+
+        /**
+         * \brief set by ~ref_counted() for the operator delete following it, as the object
+         * doesn't exist anymore, when the memory is deallocated
+         */
+        inline bool& destroyed_slab_object()
+        {
+            static thread_local bool destroyed = false;
+            return destroyed;
+        }
+
+        /**
+         * \brief RAII guard, which directs the next allocation of the current thread into a
+         * slab_pool
+         *
+         * Only an object of the pool's object size is taken from the pool, and only the first
+         * one. Objects of other types, or the ones allocated after it, e.g. by its constructor,
+         * go to the heap.
+         */
+        class slab_scope
+        {
+        public:
+            explicit slab_scope(slab_pool& pool) : previous_(active_slab_storage())
+            {
+                active_slab_storage() = &pool.storage();
+            }
+
+            slab_scope(const slab_scope&) = delete;
+            slab_scope& operator=(const slab_scope&) = delete;
+
+            ~slab_scope()
+            {
+                active_slab_storage() = previous_;
+            }
+
+        private:
+            slab_storage* previous_;
+        };
+
+        inline void* slab_allocate(std::size_t size)
+        {
+            auto storage = active_slab_storage();
+
+            if (storage != nullptr && size == storage->object_size())
+            {
+                // the scope is used up, so nested allocations don't end up in this pool
+                active_slab_storage() = nullptr;
+
+                auto object = storage->allocate();
+                pending_slab_allocation() = { object, size };
+                return object;
+            }
+
+            return ::operator new(size);
+        }
+
+        /**
+         * \brief returns whether the subobject under construction lives in the slab object
+         * allocated last
+         */
+        inline bool claim_slab_object(const void* subobject)
+        {
+            auto& pending = pending_slab_allocation();
+
+            auto begin = reinterpret_cast<std::uintptr_t>(pending.object);
+            auto address = reinterpret_cast<std::uintptr_t>(subobject);
+
+            if (pending.object == nullptr || address < begin || address >= begin + pending.size)
+            {
+                return false;
+            }
+
+            pending = {};
+            return true;
+        }
+
+        inline void slab_deallocate(void* object)
+        {
+            // an object may also go away, before it got constructed, if its constructor throws
+            auto& pending = pending_slab_allocation();
+            auto unconstructed = object != nullptr && object == pending.object;
+            if (unconstructed)
+            {
+                pending = {};
+            }
+
+            if (std::exchange(destroyed_slab_object(), false) || unconstructed)
+            {
+                slab_storage::owner(object).deallocate(object);
+            }
+            else
+            {
+                ::operator delete(object);
+            }
+        }
+    } // namespace detail
+} // namespace definition
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_DEFINITIONS_DETAIL_SLAB_POOL_HPP
@@ -165,7 +165,7 @@ namespace definition
          * \return std::vector containing reference numbers of defintions
          *
          */
-        std::vector<std::uint64_t> members() const
+        const std::vector<std::uint64_t>& members() const
         {
             assert(this->is_valid());
             return this->data_->members();
@@ -195,6 +195,55 @@ namespace definition
             return this->data_->operator[](i);
         }
 
+        /**
+         * \brief returns whether the definition is a member of the group
+         *
+         * This lookup takes constant time.
+         */
+        bool contains(const value_type& member) const
+        {
+            assert(this->is_valid());
+            return this->data_->contains(member.ref());
+        }
+
+        /**
+         * \brief returns the position of the definition in the group
+         *
+         * This is the rank of a location in a comm_locations_group. If the definition is contained
+         * multiple times, the position of the first occurrence is returned. This lookup takes
+         * constant time.
+         *
+         * \throws otf2::exception if the definition isn't a member of the group
+         */
+        std::size_t index_of(const value_type& member) const
+        {
+            assert(this->is_valid());
+            return this->data_->index_of(member.ref());
+        }
+
+        /**
+         * \brief returns the position of the member with the given reference number
+         *
+         * Same as index_of(const value_type&), but doesn't require a definition handle. Use this
+         * together with members().
+         *
+         * \throws otf2::exception if there is no such member in the group
+         */
+        std::size_t index_of(std::uint64_t ref) const
+        {
+            assert(this->is_valid());
+            return this->data_->index_of(ref);
+        }
+
+        /**
+         * \brief reserves storage for the given number of members
+         */
+        void reserve(std::size_t size)
+        {
+            assert(this->is_valid());
+            this->data_->reserve(size);
+        }
+
         /**
          * \brief adds a definition to the group
          */
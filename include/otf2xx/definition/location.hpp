@@ -147,6 +147,18 @@ namespace definition
             data_->event_written();
         }
 
+        /**
+         * \internal
+         * \brief notifies the location, that there were count events written to it.
+         *
+         * Should not called directly
+         */
+        void events_written(std::uint64_t count)
+        {
+            assert(this->is_valid());
+            data_->events_written(count);
+        }
+
         friend class writer::local;
     };
 
@@ -100,6 +100,17 @@ namespace definition
             assert(this->is_valid());
             return this->data_->id_map();
         }
+
+        /**
+         * \brief adds the mapping from the given local to the given global id
+         *
+         * Only a sparse id_map can take mappings for arbitrary local ids.
+         */
+        void add(std::uint64_t local_id, std::uint64_t global_id)
+        {
+            assert(this->is_valid());
+            this->data_->add(local_id, global_id);
+        }
     };
 } // namespace definition
 } // namespace otf2
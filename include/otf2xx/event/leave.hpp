@@ -90,6 +90,9 @@ namespace event
         }
 
         friend class otf2::writer::local;
+        friend class otf2::writer::async_local;
+        friend class otf2::writer::flight_recorder_local;
+        friend class otf2::writer::filtered_local;
 
     private:
         otf2::definition::detail::weak_ref<otf2::definition::region> region_;
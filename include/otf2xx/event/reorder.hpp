@@ -0,0 +1,451 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_EVENT_REORDER_HPP
+#define INCLUDE_OTF2XX_EVENT_REORDER_HPP
+
+#include <otf2xx/definition/definitions.hpp>
+#include <otf2xx/event/events.hpp>
+#include <otf2xx/reader/forwarding_callback.hpp>
+#include <otf2xx/tmp/algorithm.hpp>
+#include <otf2xx/traits/event.hpp>
+
+#include <otf2xx/chrono/chrono.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace otf2
+{
+namespace event
+{
+
+    namespace detail
+    {
+        /**
+         * \brief a copy of an event held back by the reorder stage
+         */
+        class reorder_node
+        {
+        public:
+            virtual ~reorder_node() = default;
+
+            virtual void emit(otf2::reader::callback& callback,
+                              const otf2::definition::location& location) const = 0;
+        };
+
+        template <typename Event>
+        class reorder_node_impl : public reorder_node
+        {
+        public:
+            reorder_node_impl(const Event& event) : event_(event)
+            {
+            }
+
+            void emit(otf2::reader::callback& callback,
+                      const otf2::definition::location& location) const override
+            {
+                callback.event(location, event_);
+            }
+
+        private:
+            Event event_;
+        };
+
+        struct reorder_entry
+        {
+            otf2::chrono::time_point timestamp;
+            std::uint64_t sequence;
+            std::unique_ptr<reorder_node> node;
+
+            // std::push_heap builds a max heap, so the order is reversed to get the oldest event
+            // on top. The sequence number keeps events with equal timestamps in reading order.
+            friend bool operator<(const reorder_entry& lhs, const reorder_entry& rhs)
+            {
+                if (lhs.timestamp != rhs.timestamp)
+                {
+                    return lhs.timestamp > rhs.timestamp;
+                }
+
+                return lhs.sequence > rhs.sequence;
+            }
+        };
+
+        struct reorder_queue
+        {
+            reorder_queue(const otf2::definition::location& location) : location(location)
+            {
+            }
+
+            otf2::definition::location location;
+            std::vector<reorder_entry> heap;
+            otf2::chrono::time_point latest = otf2::chrono::time_point::min();
+            otf2::chrono::time_point emitted = otf2::chrono::time_point::min();
+        };
+    } // namespace detail
+
+    /**
+     * \brief a callback stage, which restores the time order of the events of each location
+     *
+     * Events are held back in a min heap per location, until they are older than the newest
+     * event of the location by the given window, or the location holds more than the given
+     * number of events. So, the memory is bound by the skew of the timestamps and not by the
+     * length of the trace. All held back events are passed on in events_done().
+     *
+     * Events, which arrive later than the window allows, are still passed on, but the time order
+     * can't be restored for them. They are counted in late_events().
+     *
+     * Definitions are passed on right away.
+     */
+    class reorder
+    : public otf2::reader::forwarding_callback<
+          reorder, otf2::tmp::concat_t<otf2::traits::all_events,
+                                       otf2::tmp::typelist<otf2::event::unknown>>>
+    {
+    public:
+        /**
+         * \param[in] callback the callback, which gets the ordered events
+         * \param[in] window the maximal skew of the timestamps of a location
+         * \param[in] max_events the maximal number of held back events per location, or zero
+         *                       for no limit
+         */
+        reorder(otf2::reader::callback& callback, otf2::chrono::duration window,
+                std::size_t max_events = 0)
+        : callback_(callback), window_(window), max_events_(max_events)
+        {
+        }
+
+        /**
+         * \brief returns the number of events, which came too late to be put in order
+         */
+        std::uint64_t late_events() const
+        {
+            return late_events_;
+        }
+
+        /**
+         * \brief passes on all held back events
+         */
+        void flush()
+        {
+            for (auto& queue : queues_)
+            {
+                while (!queue.second.heap.empty())
+                {
+                    emit(queue.second);
+                }
+            }
+        }
+
+    private:
+        template <typename, typename>
+        friend class otf2::reader::detail::forwarding_callback_impl;
+
+        // holds back every event, the overrides are generated by otf2::reader::forwarding_callback
+        template <typename Event>
+        void forward(const otf2::definition::location& location, const Event& event)
+        {
+            auto it = queues_.find(location.ref());
+            if (it == queues_.end())
+            {
+                it = queues_.emplace(location.ref(), detail::reorder_queue(location)).first;
+            }
+
+            auto& queue = it->second;
+
+            if (event.timestamp() < queue.emitted)
+            {
+                ++late_events_;
+            }
+
+            queue.latest = std::max(queue.latest, event.timestamp());
+
+            queue.heap.push_back(detail::reorder_entry{
+                event.timestamp(), sequence_++,
+                std::make_unique<detail::reorder_node_impl<Event>>(event) });
+            std::push_heap(queue.heap.begin(), queue.heap.end());
+
+            while (!queue.heap.empty() &&
+                   (queue.heap.front().timestamp + window_ <= queue.latest ||
+                    (max_events_ != 0 && queue.heap.size() > max_events_)))
+            {
+                emit(queue);
+            }
+        }
+
+        void emit(detail::reorder_queue& queue)
+        {
+            std::pop_heap(queue.heap.begin(), queue.heap.end());
+
+            auto entry = std::move(queue.heap.back());
+            queue.heap.pop_back();
+
+            queue.emitted = std::max(queue.emitted, entry.timestamp);
+
+            entry.node->emit(callback_, queue.location);
+        }
+
+    public:
+        // definitions
+        void definition(const otf2::definition::attribute& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::comm& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::inter_comm& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::locations_group& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::regions_group& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::comm_locations_group& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::comm_group& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::comm_self_group& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::location& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::location_group& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::parameter& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::region& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::string& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::system_tree_node& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::system_tree_node_domain& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::clock_properties& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::call_path& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::call_path_parameter& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::source_code_location& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::calling_context& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::interrupt_generator& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::rma_win& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::io_regular_file& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::io_directory& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::io_handle& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::io_paradigm& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::io_pre_created_handle_state& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::metric_class& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::metric_class_recorder& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::metric_member& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::metric_instance& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::cart_dimension& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::cart_topology& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::cart_coordinate& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::location_property& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::location_group_property& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::system_tree_node_property& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::calling_context_property& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::io_file_property& def) override
+        {
+            callback_.definition(def);
+        }
+
+        void definition(const otf2::definition::unknown& def) override
+        {
+            callback_.definition(def);
+        }
+
+    public:
+        void definitions_done(const otf2::reader::reader& rdr) override
+        {
+            callback_.definitions_done(rdr);
+        }
+
+        void events_done(const otf2::reader::reader& rdr) override
+        {
+            flush();
+
+            callback_.events_done(rdr);
+        }
+
+    private:
+        otf2::reader::callback& callback_;
+        otf2::chrono::duration window_;
+        std::size_t max_events_;
+
+        std::map<otf2::reference<otf2::definition::location>::ref_type, detail::reorder_queue>
+            queues_;
+        std::uint64_t sequence_ = 0;
+        std::uint64_t late_events_ = 0;
+    };
+} // namespace event
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_EVENT_REORDER_HPP
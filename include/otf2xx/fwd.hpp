@@ -50,11 +50,17 @@ class definition_holder;
 template <typename Definition>
 class property_holder;
 
-template <template <typename> class GetHolderForDefinition>
+class definition_heap;
+
+class definition_arena;
+
+template <template <typename> class GetHolderForDefinition, typename Allocation = definition_heap>
 class lookup_registry;
 
 using registry = lookup_registry<get_default_holder>;
 
+using arena_registry = lookup_registry<get_default_holder, definition_arena>;
+
 class trace_reference_generator;
 
 class attribute_list;
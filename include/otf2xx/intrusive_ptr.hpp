@@ -69,7 +69,7 @@ public:
     {
     }
 
-    intrusive_ptr(intrusive_ptr&& other) : intrusive_ptr()
+    intrusive_ptr(intrusive_ptr&& other) noexcept : intrusive_ptr()
     {
         this->swap(other);
     }
@@ -88,13 +88,13 @@ public:
         return *this;
     }
 
-    intrusive_ptr& operator=(intrusive_ptr&& other)
+    intrusive_ptr& operator=(intrusive_ptr&& other) noexcept
     {
         intrusive_ptr(std::move(other)).swap(*this);
         return *this;
     }
 
-    void swap(intrusive_ptr& other)
+    void swap(intrusive_ptr& other) noexcept
     {
         std::swap(data_, other.data_);
     }
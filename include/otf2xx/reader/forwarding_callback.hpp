@@ -0,0 +1,107 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2018, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_READER_FORWARDING_CALLBACK_HPP
+#define INCLUDE_OTF2XX_READER_FORWARDING_CALLBACK_HPP
+
+#include <otf2xx/reader/callback.hpp>
+
+#include <otf2xx/definition/location.hpp>
+#include <otf2xx/event/events.hpp>
+#include <otf2xx/tmp/typelist.hpp>
+#include <otf2xx/traits/event.hpp>
+
+namespace otf2
+{
+namespace reader
+{
+
+    namespace detail
+    {
+        /**
+         * \brief overrides the event callback of each type of the list
+         *
+         * Every level of the chain overrides one type and pulls in the overloads of the levels
+         * above, so the whole chain has exactly one override per type.
+         */
+        template <typename Derived, typename Events>
+        class forwarding_callback_impl;
+
+        template <typename Derived>
+        class forwarding_callback_impl<Derived, otf2::tmp::typelist<>>
+        : public otf2::reader::callback
+        {
+        };
+
+        template <typename Derived, typename Event, typename... Events>
+        class forwarding_callback_impl<Derived, otf2::tmp::typelist<Event, Events...>>
+        : public forwarding_callback_impl<Derived, otf2::tmp::typelist<Events...>>
+        {
+        public:
+            using forwarding_callback_impl<Derived, otf2::tmp::typelist<Events...>>::event;
+
+            void event(const otf2::definition::location& location, const Event& event) override
+            {
+                static_cast<Derived&>(*this).forward(location, event);
+            }
+        };
+    } // namespace detail
+
+    /**
+     * \brief base class for callbacks, which pass every event on unchanged
+     *
+     * Overrides the event callback of every event in the list with a call to
+     * Derived::forward(location, event). So, no event falls back to the default of
+     * otf2::reader::callback, e.g. calling context enter and leave events stay what they are
+     * instead of being turned into enter and leave events. Derived classes may still override
+     * single events themselves. Definitions aren't touched.
+     *
+     * If forward() isn't public, declare the implementation a friend:
+     *
+     * template <typename, typename>
+     * friend class otf2::reader::detail::forwarding_callback_impl;
+     *
+     * \tparam Derived the class providing forward() for all events of the list
+     * \tparam Events a typelist of the events to forward, all events of a local writer by default
+     */
+    template <typename Derived, typename Events = otf2::traits::all_events>
+    class forwarding_callback : public detail::forwarding_callback_impl<Derived, Events>
+    {
+    public:
+        using detail::forwarding_callback_impl<Derived, Events>::event;
+    };
+} // namespace reader
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_READER_FORWARDING_CALLBACK_HPP
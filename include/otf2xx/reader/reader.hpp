@@ -35,9 +35,11 @@
 #ifndef INCLUDE_OTF2XX_READER_READER_HPP
 #define INCLUDE_OTF2XX_READER_READER_HPP
 
+#include <otf2xx/chrono/clock_correction.hpp>
 #include <otf2xx/chrono/convert.hpp>
 #include <otf2xx/definition/definitions.hpp>
 #include <otf2xx/event/buffer.hpp>
+#include <otf2xx/event/reorder.hpp>
 #include <otf2xx/exception.hpp>
 #include <otf2xx/reader/callback.hpp>
 #include <otf2xx/reader/fwd.hpp>
@@ -56,6 +58,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace otf2
@@ -405,6 +408,22 @@ namespace reader
             }
         }
 
+        /**
+         * \brief set the given callback, which gets the events of each location ordered by time
+         *
+         * Uses otf2::event::reorder internally.
+         *
+         * \param callback an otf2::reader::callback instance
+         * \param window the maximal skew of the timestamps of a location
+         * \param max_events the maximal number of held back events per location, zero for none
+         */
+        void set_callback(otf2::reader::callback& callback, otf2::chrono::duration window,
+                          std::size_t max_events = 0)
+        {
+            reorder_.reset(new otf2::event::reorder(callback, window, max_events));
+            callback_ = reorder_.get();
+        }
+
         reader(reader&) = delete;
         reader& operator=(reader&) = delete;
 
@@ -485,6 +504,54 @@ namespace reader
             return clock_convert_;
         }
 
+        /**
+         * \brief sets a correction for the clock of the given location
+         *
+         * The correction is applied to the timestamps of all events of this location, before they
+         * are converted to time points. So, the callback gets the corrected timeline.
+         *
+         * \param [in] location the location, whose timestamps should be corrected
+         * \param [in] correction maps the ticks of the location to the ticks of the trace
+         */
+        void set_clock_correction(const otf2::definition::location& location,
+                                  otf2::chrono::clock_correction correction)
+        {
+            clock_corrections_[location.ref()] = std::move(correction);
+        }
+
+        /**
+         * \brief converts a timestamp of the given location to a time point
+         *
+         * Applies the clock correction of the location, if there is any.
+         *
+         * \throws otf2::exception if the correction moves the timestamp before the start of the
+         *         trace
+         */
+        otf2::chrono::time_point convert_time(OTF2_LocationRef location,
+                                              OTF2_TimeStamp timestamp) const
+        {
+            if (clock_corrections_.empty())
+            {
+                return clock_convert_(otf2::chrono::ticks(timestamp));
+            }
+
+            auto it = clock_corrections_.find(location);
+            if (it == clock_corrections_.end())
+            {
+                return clock_convert_(otf2::chrono::ticks(timestamp));
+            }
+
+            auto corrected = it->second(otf2::chrono::ticks(timestamp));
+
+            if (corrected.count() < clock_convert_.offset().count())
+            {
+                make_exception("The corrected timestamp ", corrected.count(), " of location ",
+                               location, " is before the start of the trace");
+            }
+
+            return clock_convert_(corrected);
+        }
+
     private:
         OTF2_Reader* rdr;
 
@@ -500,8 +567,10 @@ namespace reader
 
         std::unique_ptr<otf2::definition::clock_properties> clock_properties_;
         otf2::chrono::convert clock_convert_;
+        std::unordered_map<OTF2_LocationRef, otf2::chrono::clock_correction> clock_corrections_;
 
         std::unique_ptr<otf2::reader::callback> buffer_;
+        std::unique_ptr<otf2::event::reorder> reorder_;
         otf2::reader::callback* callback_;
     };
 
@@ -38,10 +38,13 @@
 #pragma once
 
 #include <otf2xx/definition/definitions.hpp>
+#include <otf2xx/definition/detail/slab_pool.hpp>
+#include <otf2xx/exception.hpp>
 #include <otf2xx/fwd.hpp>
 #include <otf2xx/reference.hpp>
 #include <otf2xx/reference_generator.hpp>
 
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -63,18 +66,20 @@ public:
 public:
     const Definition& operator[](typename Definition::reference_type ref) const
     {
-        return definitions_[ref];
+        return is_flushed(ref) ? flushed_[ref] : definitions_[ref];
     }
 
     Definition& operator[](typename Definition::reference_type ref)
     {
-        return definitions_[ref];
+        return is_flushed(ref) ? flushed_[ref] : definitions_[ref];
     }
 
     void operator()(const Definition& def)
     {
         assert(def.ref() != Definition::reference_type::undefined());
 
+        check_not_flushed(def.ref());
+
         definitions_.add_definition(def);
         refs_.register_definition(def);
     }
@@ -83,6 +88,8 @@ public:
     {
         assert(ref.ref() != Definition::reference_type::undefined());
 
+        check_not_flushed(ref.ref());
+
         auto def = ref.lock();
         refs_.register_definition(def);
         definitions_.add_definition(std::move(def));
@@ -106,6 +113,8 @@ public:
     {
         // TODO I fucking bet that some day there will be a definition, where this is well-formed in
         // the case you wanted to omit the ref FeelsBadMan
+        check_not_flushed(ref);
+
         auto& def = definitions_.emplace(ref, std::forward<Args>(args)...);
         refs_.register_definition(def);
         return def;
@@ -130,7 +139,8 @@ public:
         // TODO I fucking bet that some day there will be a definition, where this is well-formed in
         // the case you wanted to omit the ref FeelsBadMan
 
-        if (!definitions_.count(ref))
+        // a flushed definition was already written, so it must not be created again
+        if (!has(ref))
         {
             auto& def = definitions_.emplace(ref, std::forward<Args>(args)...);
             refs_.register_definition(def);
@@ -139,25 +149,38 @@ public:
         }
         else
         {
-            return definitions_[ref];
+            return (*this)[ref];
         }
     }
 
+    /**
+     * \brief returns whether the reference is taken, either by a definition or a flushed one
+     */
     bool has(typename Definition::reference_type ref) const
     {
-        return definitions_.count(ref) > 0;
+        return definitions_.count(ref) > 0 || is_flushed(ref);
     }
 
     Definition& find(typename Definition::reference_type ref)
     {
         auto it = definitions_.find(ref);
-        return it != definitions_.end() ? *it : definitions_[ref.undefined()];
+        if (it != definitions_.end())
+        {
+            return *it;
+        }
+
+        return is_flushed(ref) ? flushed_[ref] : definitions_[ref.undefined()];
     }
 
     const Definition& find(typename Definition::reference_type ref) const
     {
         auto it = definitions_.find(ref);
-        return it != definitions_.end() ? *it : definitions_[ref.undefined()];
+        if (it != definitions_.end())
+        {
+            return *it;
+        }
+
+        return is_flushed(ref) ? flushed_[ref] : definitions_[ref.undefined()];
     }
 
     const otf2::definition::container<Definition>& data() const
@@ -165,6 +188,23 @@ public:
         return definitions_;
     }
 
+    /**
+     * \brief removes all definitions from the holder and returns them
+     *
+     * The reference numbers of the removed definitions stay reserved. The holder keeps a handle
+     * for each of them, which only carries the reference, so lookups still find them and they
+     * can't be created again. Their data is released with the returned definitions.
+     */
+    otf2::definition::container<Definition> take()
+    {
+        for (const auto& def : definitions_)
+        {
+            flushed_.emplace(def.ref());
+        }
+
+        return std::exchange(definitions_, {});
+    }
+
     auto begin() const
     {
         return definitions_.begin();
@@ -176,8 +216,24 @@ public:
     }
 
 protected:
+    bool is_flushed(typename Definition::reference_type ref) const
+    {
+        return flushed_.count(ref) > 0;
+    }
+
+    void check_not_flushed(typename Definition::reference_type ref) const
+    {
+        if (is_flushed(ref))
+        {
+            make_exception("Tried to define the already flushed reference ", ref.get());
+        }
+    }
+
     otf2::definition::container<Definition> definitions_;
     otf2::trace_reference_generator& refs_;
+
+    // the definitions taken out of the holder, which only carry their reference
+    otf2::definition::container<Definition> flushed_;
 };
 
 template <typename Definition, typename... KeyList>
@@ -247,6 +303,8 @@ public:
     {
         assert(def.ref() != Definition::reference_type::undefined());
 
+        this->check_not_flushed(def.ref());
+
         std::get<Index<Key, key_list>::value>(lookup_maps_).emplace(key.key, def);
         this->definitions_.add_definition(def);
         this->refs_.register_definition(def);
@@ -258,6 +316,8 @@ public:
     {
         assert(ref.ref() != Definition::reference_type::undefined());
 
+        this->check_not_flushed(ref.ref());
+
         auto def = ref.lock();
         this->refs_.register_definition(def);
         this->definitions_.add_definition(def);
@@ -301,6 +361,8 @@ public:
     {
         // TODO I fucking bet that some day there will be a definition, where this is well-formed in
         // the case you wanted to omit the ref FeelsBadMan
+        this->check_not_flushed(ref);
+
         auto result = std::get<Index<Key, key_list>::value>(lookup_maps_)
                           .emplace(std::piecewise_construct, std::forward_as_tuple(key.key),
                                    std::forward_as_tuple(ref, std::forward<Args>(args)...));
@@ -336,7 +398,32 @@ public:
                                          (*this)[otf2::reference<Definition>::undefined()];
     }
 
+    /**
+     * \brief removes all definitions from the holder and returns them
+     *
+     * The lookup maps only keep the references of the removed definitions, so their memory is
+     * released, once the returned ones are gone. Keyed lookups still find them, but return a
+     * definition, which only carries the reference and isn't valid otherwise.
+     */
+    otf2::definition::container<Definition> take()
+    {
+        std::apply([](auto&... maps) { (release(maps), ...); }, lookup_maps_);
+
+        return base::take();
+    }
+
 private:
+    template <typename Map>
+    static void release(Map& map)
+    {
+        for (auto& entry : map)
+        {
+            // only swaps the data, so the entry keeps its reference
+            Definition released;
+            swap(entry.second, released);
+        }
+    }
+
     std::tuple<std::map<typename KeyList::key_type, Definition>...> lookup_maps_;
 };
 
@@ -364,6 +451,11 @@ public:
         return properties_;
     }
 
+    otf2::definition::container<Property> take()
+    {
+        return std::exchange(properties_, {});
+    }
+
     auto begin() const
     {
         return properties_.begin();
@@ -444,10 +536,76 @@ struct get_variant_helper<Registry, Result, Definition>
     }
 };
 
-template <template <typename> class GetHolderForDefinition>
+/**
+ * \brief allocation policy for lookup_registry, which puts every definition on the heap
+ */
+class definition_heap
+{
+public:
+    struct scope
+    {
+    };
+
+    template <typename Definition>
+    scope allocate()
+    {
+        return {};
+    }
+};
+
+/**
+ * \brief allocation policy for lookup_registry, which puts definitions into per-type slab pools
+ *
+ * Definitions created through the registry are allocated in large slabs instead of one heap
+ * allocation each. Refcounting still decides when a definition is destroyed; while the registry
+ * exists, its slot is then recycled for the next definition of the same type. When the registry
+ * goes away, its definitions are only destroyed, and all slabs are freed at once with the last
+ * handle into them.
+ */
+class definition_arena
+{
+    template <typename Definition>
+    struct pool : otf2::definition::detail::slab_pool
+    {
+        pool() : slab_pool(sizeof(typename Definition::impl_type))
+        {
+        }
+    };
+
+    template <typename Definition>
+    struct make_pool
+    {
+        using type = pool<Definition>;
+    };
+
+    using pools = tmp::apply_t<tmp::transform_t<traits::usable_definitions, make_pool>, std::tuple>;
+
+public:
+    using scope = otf2::definition::detail::slab_scope;
+
+    template <typename Definition>
+    scope allocate()
+    {
+        return scope(std::get<pool<Definition>>(pools_));
+    }
+
+    /**
+     * \brief returns the slab pool used for definitions of the given type
+     */
+    template <typename Definition>
+    const otf2::definition::detail::slab_pool& get() const
+    {
+        return std::get<pool<Definition>>(pools_);
+    }
+
+private:
+    pools pools_;
+};
+
+template <template <typename> class GetHolderForDefinition, typename Allocation>
 class lookup_registry
 {
-    using self = lookup_registry<GetHolderForDefinition>;
+    using self = lookup_registry<GetHolderForDefinition, Allocation>;
 
     using holders =
         tmp::apply_t<tmp::transform_t<traits::usable_definitions, GetHolderForDefinition>,
@@ -498,6 +656,7 @@ public:
     template <typename Definition, typename... Args>
     auto& create(Args&&... args)
     {
+        [[maybe_unused]] auto scope = allocation_.template allocate<Definition>();
         return get_holder<Definition>().create(std::forward<Args>(args)...);
     }
 
@@ -510,6 +669,7 @@ public:
     template <typename Definition, typename... Args>
     auto& emplace(Args&&... args)
     {
+        [[maybe_unused]] auto scope = allocation_.template allocate<Definition>();
         return get_holder<Definition>().emplace(std::forward<Args>(args)...);
     }
 
@@ -533,6 +693,18 @@ public:
         return get_holder<Definition>()[key];
     }
 
+    /**
+     * \brief removes all definitions of the given type from the registry and returns them
+     *
+     * Keyed lookups of a lookup_definition_holder still find the references of the removed
+     * definitions, but not their data.
+     */
+    template <typename Definition>
+    auto take()
+    {
+        return get_holder<Definition>().take();
+    }
+
     template <typename Definition, typename Key>
     bool has(const Key& key) const
     {
@@ -570,10 +742,19 @@ public:
         return holders_;
     }
 
+    const Allocation& allocation() const
+    {
+        return allocation_;
+    }
+
 private:
     trace_reference_generator refs_;
 
     holders holders_;
+
+    // declared last, so the pools are orphaned before the definitions are released, which then
+    // skips recycling their slots
+    Allocation allocation_;
 };
 
 // template <typename Definition, typename... KeyList>
@@ -59,6 +59,10 @@ namespace tmp
     template <class Seq>
     struct size;
 
+    /** @brief Return the position of the type ToSearch in the sequence, which must contain it */
+    template <class Seq, typename ToSearch>
+    struct index_of;
+
     /** @brief Concatenate multiple typelists into one */
     template <typename... TLists>
     struct concat;
@@ -118,6 +122,17 @@ namespace tmp
     {
     };
 
+    template <typename ToSearch, template <typename...> class Seq, typename... Ts>
+    struct index_of<Seq<ToSearch, Ts...>, ToSearch> : std::integral_constant<std::size_t, 0>
+    {
+    };
+
+    template <typename ToSearch, template <typename...> class Seq, typename T, typename... Ts>
+    struct index_of<Seq<T, Ts...>, ToSearch>
+    : std::integral_constant<std::size_t, 1 + index_of<Seq<Ts...>, ToSearch>::value>
+    {
+    };
+
     template <>
     struct concat<>
     {
@@ -36,6 +36,7 @@
 #define INCLUDE_OTF2XX_TRAITS_EVENT_HPP
 
 #include <otf2xx/event/fwd.hpp>
+#include <otf2xx/tmp/typelist.hpp>
 #include <type_traits>
 
 namespace otf2
@@ -43,6 +44,86 @@ namespace otf2
 namespace traits
 {
 
+    // clang-format off
+
+    /// All events, which can be written by a local writer
+    using all_events = tmp::typelist<
+        otf2::event::buffer_flush,
+        otf2::event::enter,
+        otf2::event::leave,
+        otf2::event::measurement,
+        otf2::event::metric,
+        otf2::event::mpi_send,
+        otf2::event::mpi_receive,
+        otf2::event::mpi_isend_request,
+        otf2::event::mpi_isend_complete,
+        otf2::event::mpi_ireceive_complete,
+        otf2::event::mpi_ireceive_request,
+        otf2::event::mpi_request_test,
+        otf2::event::mpi_request_cancelled,
+        otf2::event::mpi_collective_begin,
+        otf2::event::mpi_collective_end,
+        otf2::event::non_blocking_collective_request,
+        otf2::event::non_blocking_collective_complete,
+        otf2::event::comm_create,
+        otf2::event::comm_destroy,
+        otf2::event::parameter_string,
+        otf2::event::parameter_int,
+        otf2::event::parameter_unsigned_int,
+        otf2::event::calling_context_enter,
+        otf2::event::calling_context_leave,
+        otf2::event::calling_context_sample,
+        otf2::event::thread_fork,
+        otf2::event::thread_join,
+        otf2::event::thread_team_begin,
+        otf2::event::thread_team_end,
+        otf2::event::thread_acquire_lock,
+        otf2::event::thread_release_lock,
+        otf2::event::thread_task_create,
+        otf2::event::thread_task_switch,
+        otf2::event::thread_task_complete,
+        otf2::event::thread_create,
+        otf2::event::thread_begin,
+        otf2::event::thread_wait,
+        otf2::event::thread_end,
+        otf2::event::rma_acquire_lock,
+        otf2::event::rma_atomic,
+        otf2::event::rma_collective_begin,
+        otf2::event::rma_collective_end,
+        otf2::event::rma_get,
+        otf2::event::rma_group_sync,
+        otf2::event::rma_op_complete_blocking,
+        otf2::event::rma_op_complete_non_blocking,
+        otf2::event::rma_op_complete_remote,
+        otf2::event::rma_op_test,
+        otf2::event::rma_put,
+        otf2::event::rma_release_lock,
+        otf2::event::rma_request_lock,
+        otf2::event::rma_sync,
+        otf2::event::rma_try_lock,
+        otf2::event::rma_wait_change,
+        otf2::event::rma_win_create,
+        otf2::event::rma_win_destroy,
+        otf2::event::io_create_handle,
+        otf2::event::io_destroy_handle,
+        otf2::event::io_duplicate_handle,
+        otf2::event::io_seek,
+        otf2::event::io_change_status_flag,
+        otf2::event::io_delete_file,
+        otf2::event::io_operation_begin,
+        otf2::event::io_operation_test,
+        otf2::event::io_operation_issued,
+        otf2::event::io_operation_cancelled,
+        otf2::event::io_operation_complete,
+        otf2::event::io_acquire_lock,
+        otf2::event::io_release_lock,
+        otf2::event::io_try_lock,
+        otf2::event::program_begin,
+        otf2::event::program_end
+    >;
+
+    // clang-format on
+
     template <typename Type>
     struct is_event : std::false_type
     {
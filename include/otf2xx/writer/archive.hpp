@@ -41,22 +41,111 @@
 #include <otf2xx/exception.hpp>
 #include <otf2xx/fwd.hpp>
 
+#include <otf2xx/writer/chunk_pool.hpp>
+#include <otf2xx/writer/flush_policy.hpp>
 #include <otf2xx/writer/global.hpp>
 #include <otf2xx/writer/local.hpp>
+#include <otf2xx/writer/profile.hpp>
+#include <otf2xx/writer/statistics.hpp>
 
 #ifdef OTF2XX_HAS_MPI
 #include <mpi.h>
 #include <otf2/OTF2_MPI_Collectives.h>
 #endif
 
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
 #include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <string>
+#include <system_error>
+#include <tuple>
 #include <vector>
 
 namespace otf2
 {
 namespace writer
 {
+    namespace detail
+    {
+        inline OTF2_CallbackCode lock_create(void*, OTF2_Lock* lock)
+        {
+            *lock = reinterpret_cast<OTF2_Lock>(new (std::nothrow) std::mutex);
+
+            return *lock != nullptr ? OTF2_CALLBACK_SUCCESS : OTF2_CALLBACK_ERROR;
+        }
+
+        inline OTF2_CallbackCode lock_destroy(void*, OTF2_Lock lock)
+        {
+            delete reinterpret_cast<std::mutex*>(lock);
+
+            return OTF2_CALLBACK_SUCCESS;
+        }
+
+        inline OTF2_CallbackCode lock_lock(void*, OTF2_Lock lock)
+        {
+            try
+            {
+                reinterpret_cast<std::mutex*>(lock)->lock();
+            }
+            catch (...)
+            {
+                return OTF2_CALLBACK_ERROR;
+            }
+
+            return OTF2_CALLBACK_SUCCESS;
+        }
+
+        inline OTF2_CallbackCode lock_unlock(void*, OTF2_Lock lock)
+        {
+            reinterpret_cast<std::mutex*>(lock)->unlock();
+
+            return OTF2_CALLBACK_SUCCESS;
+        }
+
+        /**
+         * \brief locking callbacks for OTF2, which use std::mutex
+         */
+        inline const OTF2_LockingCallbacks* locking_callbacks()
+        {
+            static const OTF2_LockingCallbacks callbacks = []()
+            {
+                OTF2_LockingCallbacks result;
+                result.otf2_release = nullptr;
+                result.otf2_create = lock_create;
+                result.otf2_destroy = lock_destroy;
+                result.otf2_lock = lock_lock;
+                result.otf2_unlock = lock_unlock;
+                return result;
+            }();
+
+            return &callbacks;
+        }
+
+        /**
+         * \brief returns a process-wide unique number to tag the set of local writers with
+         */
+        inline std::uint64_t next_writers_generation()
+        {
+            static std::atomic<std::uint64_t> generation(0);
+
+            return ++generation;
+        }
+    } // namespace detail
+
+    /**
+     * \brief writer for an OTF2 archive
+     *
+     * The archive can be shared between threads: It installs locking callbacks in OTF2 and
+     * creates the local writers under a lock. Each local writer must only be used by one thread
+     * at a time, which is usually the thread recording the events of its location. Definitions
+     * still have to be written from one thread at a time. Sharing the archive between threads
+     * needs atomic reference counts, see OTF2XX_ATOMIC_REFCOUNT.
+     */
     template <typename Registry>
     class Archive
     {
@@ -70,12 +159,13 @@ namespace writer
                 OTF2_Compression_enum compression = OTF2_COMPRESSION_NONE)
         : ar(OTF2_Archive_Open(path.c_str(), name.c_str(), mode, event_chunk_size,
                                definition_chunk_size, file_substrate, compression)),
-          serial(false)
+          serial(false), path_(path), name_(name)
         {
             if (ar == nullptr)
                 make_exception("Couldn't open the archive '", name, "'");
 
             set_flush_callbacks();
+            set_locking_callbacks();
 
             check(OTF2_MPI_Archive_SetCollectiveCallbacks(ar, comm, MPI_COMM_NULL),
                   "Couldn't set collective callbacks");
@@ -96,12 +186,13 @@ namespace writer
                 OTF2_Compression_enum compression = OTF2_COMPRESSION_NONE)
         : ar(OTF2_Archive_Open(path.c_str(), name.c_str(), mode, event_chunk_size,
                                definition_chunk_size, file_substrate, compression)),
-          serial(true)
+          serial(true), path_(path), name_(name)
         {
             if (ar == nullptr)
                 make_exception("Couldn't open the archive '", name, "'");
 
             set_flush_callbacks();
+            set_locking_callbacks();
             OTF2_Archive_SetSerialCollectiveCallbacks(ar);
 
             check(OTF2_Archive_OpenDefFiles(ar), "Couldn't open definition files");
@@ -132,6 +223,22 @@ namespace writer
             return ar;
         }
 
+        /**
+         * \brief returns the directory of the archive, which is empty if it was taken over
+         */
+        const std::string& path() const
+        {
+            return path_;
+        }
+
+        /**
+         * \brief returns the name of the anchor file and the directory of the local files
+         */
+        const std::string& name() const
+        {
+            return name_;
+        }
+
     private:
         void set_flush_callbacks()
         {
@@ -145,6 +252,31 @@ namespace writer
                    __attribute__((unused)) bool final) { return OTF2_FLUSH; };
         }
 
+        void set_locking_callbacks()
+        {
+            check(OTF2_Archive_SetLockingCallbacks(ar, detail::locking_callbacks(), nullptr),
+                  "Couldn't set locking callbacks");
+        }
+
+    public:
+        /**
+         * \brief lets OTF2 take the buffer chunks of this archive from the given pool
+         *
+         * This has to be called before any writer is requested from the archive. The pool must
+         * outlive the archive.
+         */
+        void set_memory_callbacks(chunk_pool& pool)
+        {
+            if (pool.chunk_size() < get_events_chunk_size() ||
+                pool.chunk_size() < get_definitions_chunk_size())
+            {
+                make_exception("The chunks of the pool are smaller than the chunks of the archive");
+            }
+
+            check(OTF2_Archive_SetMemoryCallbacks(ar, chunk_pool::callbacks(), &pool),
+                  "Couldn't set memory callbacks");
+        }
+
     public:
         bool is_slave() const
         {
@@ -161,6 +293,29 @@ namespace writer
 #endif
         }
 
+    public:
+        /**
+         * \brief sets the clock used to convert the event timestamps of all writers to ticks
+         *
+         * Writing the clock properties to the global writer does this implicitly. Slaves don't
+         * have a global writer, so they have to call this before writing any event.
+         */
+        void set_clock_properties(const otf2::definition::clock_properties& cp)
+        {
+            clock_convert_ = otf2::chrono::convert(cp.ticks_per_second());
+        }
+
+        /**
+         * \brief sets the conversion of the event timestamps of all writers to ticks directly
+         *
+         * Unlike set_clock_properties(), this can keep an offset, e.g. to write time points
+         * read from a trace back with their original ticks.
+         */
+        void set_clock_convert(const otf2::chrono::convert& cvrt)
+        {
+            clock_convert_ = cvrt;
+        }
+
     public:
         void set_creator(const std::string& creator)
         {
@@ -355,20 +510,158 @@ namespace writer
 
         void set_pre_flush_callback(pre_flush_func f)
         {
+            flush_policy_ = nullptr;
             pre_flush_callback_ = f;
         }
 
         void set_post_flush_callback(post_flush_func f)
         {
+            flush_policy_ = nullptr;
             flush_callbacks_.otf2_post_flush = detail::post_flush<Registry>;
             post_flush_callback_ = f;
         }
 
+        /**
+         * \brief lets the given policy coordinate the buffer flushes of this archive
+         *
+         * This replaces the pre and post flush callbacks. The policy must outlive the archive.
+         */
+        void set_flush_policy(flush_policy& policy)
+        {
+            set_post_flush_callback([&policy](otf2::reference<otf2::definition::location> location)
+                                    { return policy.post_flush(location); });
+
+            // the policy needs the file type, so it's called directly by the flush callback
+            flush_policy_ = &policy;
+        }
+
         Registry& registry()
         {
             return get_global_writer().registry();
         }
 
+        /**
+         * \brief switches all local writers from tracing to profiling
+         *
+         * The local writers aggregate their enter, leave and metric events to a call-path profile
+         * and write it on close, see otf2::writer::local::enable_profiling(). This creates the
+         * summary metric class in the registry, so it is only available on the master.
+         *
+         * This has to be called before any enter, leave or metric event is written, and only
+         * once.
+         */
+        void enable_profiling()
+        {
+            {
+                std::lock_guard<std::mutex> lock(local_writers_mutex_);
+
+                check_not_profiling();
+            }
+
+            enable_profiling(profile::make_summary(registry()));
+        }
+
+        /**
+         * \brief switches all local writers from tracing to profiling with the given summary
+         *
+         * Slaves have to pass the same metric class as the master.
+         */
+        void enable_profiling(const otf2::definition::metric_class& summary)
+        {
+            std::lock_guard<std::mutex> lock(local_writers_mutex_);
+
+            check_not_profiling();
+
+            profile_summary_ = summary;
+
+            for (auto& writer : local_writers_)
+            {
+                writer.second.enable_profiling(summary);
+            }
+        }
+
+        /**
+         * \brief counts the events, flushes and time spent in OTF2 of all local writers
+         *
+         * See otf2::writer::local::enable_statistics(). This has to be called before any event is
+         * written.
+         */
+        void enable_statistics()
+        {
+            std::lock_guard<std::mutex> lock(local_writers_mutex_);
+
+            statistics_enabled_ = true;
+
+            for (auto& writer : local_writers_)
+            {
+                writer.second.enable_statistics();
+            }
+        }
+
+        /**
+         * \brief counts like enable_statistics() and writes the counters of each local writer
+         *        as metric event to the trace, when it is closed
+         *
+         * \param metrics the metric class, e.g. otf2::writer::statistics::make_metrics() of the
+         *        registry of the master
+         */
+        void enable_statistics(const otf2::definition::metric_class& metrics)
+        {
+            std::lock_guard<std::mutex> lock(local_writers_mutex_);
+
+            statistics_enabled_ = true;
+            statistics_metrics_ = metrics;
+
+            for (auto& writer : local_writers_)
+            {
+                writer.second.enable_statistics(metrics);
+            }
+        }
+
+        /**
+         * \brief returns the counters of the local writer of the given location
+         *
+         * The bytes are the size of its event file, so they don't include the buffered events.
+         */
+        otf2::writer::statistics statistics(const otf2::definition::location& loc)
+        {
+            std::lock_guard<std::mutex> lock(local_writers_mutex_);
+
+            otf2::writer::statistics result;
+
+            auto it = local_writers_.find(loc.ref());
+            if (it != local_writers_.end() && it->second.statistics() != nullptr)
+            {
+                result = *it->second.statistics();
+                result.set_bytes(event_file_size(loc.ref()));
+            }
+
+            return result;
+        }
+
+        /**
+         * \brief returns the sums of the counters of all local writers, including closed ones
+         */
+        otf2::writer::statistics statistics()
+        {
+            std::lock_guard<std::mutex> lock(local_writers_mutex_);
+
+            otf2::writer::statistics result = closed_statistics_;
+
+            for (const auto& writer : local_writers_)
+            {
+                if (writer.second.statistics() != nullptr)
+                {
+                    otf2::writer::statistics stats = *writer.second.statistics();
+                    stats.set_bytes(event_file_size(writer.first));
+
+                    result += stats;
+                }
+            }
+
+            return result;
+        }
+
     public:
         writer::local& operator()(const otf2::definition::location& loc)
         {
@@ -388,9 +681,12 @@ namespace writer
         {
             if (is_master())
             {
+                std::lock_guard<std::mutex> lock(global_writer_mutex_);
+
                 if (!global_writer_)
                     global_writer_.reset(new global<Registry>(OTF2_Archive_GetGlobalDefWriter(ar),
-                                                              OTF2_Archive_GetMarkerWriter(ar)));
+                                                              OTF2_Archive_GetMarkerWriter(ar),
+                                                              clock_convert_));
             }
             else
             {
@@ -403,16 +699,59 @@ namespace writer
             return *global_writer_;
         }
 
+        /**
+         * \brief returns the local writer for the given location and creates it if necessary
+         *
+         * This is thread-safe. Every thread remembers the writer it got last, so repeated calls
+         * for the same location don't take the lock.
+         */
         local& get_local_writer(const otf2::definition::location& loc)
         {
+            struct cached_writer
+            {
+                std::uint64_t generation = 0;
+                otf2::reference<otf2::definition::location>::ref_type location = 0;
+                local* writer = nullptr;
+            };
+
+            thread_local cached_writer cache;
+
+            auto generation = writers_generation_.load(std::memory_order_acquire);
+
+            if (cache.generation == generation && cache.location == loc.ref().get())
+            {
+                return *cache.writer;
+            }
+
+            std::lock_guard<std::mutex> lock(local_writers_mutex_);
+
             auto it = local_writers_.find(loc.ref());
             if (it == local_writers_.end())
             {
-                auto res = local_writers_.emplace(
-                    std::piecewise_construct, std::make_tuple(loc.ref()), std::make_tuple(ar, loc));
+                auto res = local_writers_.emplace(std::piecewise_construct,
+                                                  std::make_tuple(loc.ref()),
+                                                  std::forward_as_tuple(ar, loc, clock_convert_));
                 it = res.first;
+
+                if (profile_summary_.is_valid())
+                {
+                    it->second.enable_profiling(profile_summary_);
+                }
+
+                if (statistics_metrics_.is_valid())
+                {
+                    it->second.enable_statistics(statistics_metrics_);
+                }
+                else if (statistics_enabled_)
+                {
+                    it->second.enable_statistics();
+                }
             }
 
+            cache.generation = generation;
+            cache.location = loc.ref().get();
+            cache.writer = &it->second;
+
             return it->second;
         }
 
@@ -424,6 +763,8 @@ namespace writer
          */
         void close_local_writer(const otf2::definition::location& loc)
         {
+            std::lock_guard<std::mutex> lock(local_writers_mutex_);
+
             auto it = local_writers_.find(loc.ref());
 
             if (it == local_writers_.end())
@@ -431,7 +772,47 @@ namespace writer
                 make_exception("Cannot close not existing writer for location #", loc.ref());
             }
 
+            // close first, so errors of writing the profile or the statistics aren't swallowed by
+            // the destructor and the final flush is counted
+            it->second.close_event_writer();
+
+            if (it->second.statistics() != nullptr)
+            {
+                otf2::writer::statistics stats = *it->second.statistics();
+                stats.set_bytes(event_file_size(loc.ref()));
+
+                closed_statistics_ += stats;
+            }
+
             local_writers_.erase(it);
+
+            // invalidate the writers cached by the threads
+            writers_generation_.store(detail::next_writers_generation(), std::memory_order_release);
+        }
+
+    private:
+        // a second profile would discard the profiles collected so far
+        void check_not_profiling() const
+        {
+            if (profile_summary_.is_valid())
+            {
+                make_exception("Profiling is already enabled for this archive");
+            }
+        }
+
+        // the size of the flushed events of the location, or 0 if it isn't known
+        std::uint64_t event_file_size(otf2::reference<otf2::definition::location>::ref_type ref)
+        {
+            if (path_.empty())
+            {
+                return 0;
+            }
+
+            std::error_code error;
+            auto size = std::filesystem::file_size(
+                std::filesystem::path(path_) / name_ / (std::to_string(ref) + ".evt"), error);
+
+            return error ? 0 : size;
         }
 
     private:
@@ -440,12 +821,30 @@ namespace writer
 #ifdef OTF2XX_HAS_MPI
         bool is_master_;
 #endif
+        std::string path_;
+        std::string name_;
         OTF2_FlushCallbacks flush_callbacks_;
         post_flush_func post_flush_callback_;
         pre_flush_func pre_flush_callback_;
+        flush_policy* flush_policy_ = nullptr;
 
+        // shared by all writers, configured by the clock properties
+        otf2::chrono::convert clock_convert_;
+
+        std::mutex global_writer_mutex_;
         std::unique_ptr<global<Registry>> global_writer_;
+
+        std::mutex local_writers_mutex_;
+        std::atomic<std::uint64_t> writers_generation_{ detail::next_writers_generation() };
         std::map<otf2::reference<otf2::definition::location>::ref_type, local> local_writers_;
+
+        // set if the local writers profile instead of trace
+        otf2::definition::metric_class profile_summary_;
+
+        // set if the local writers count their work, and the metric class to write it
+        bool statistics_enabled_ = false;
+        otf2::definition::metric_class statistics_metrics_;
+        otf2::writer::statistics closed_statistics_;
     };
 
     template <typename Anything, typename Registry>
@@ -481,11 +880,23 @@ namespace writer
 
         template <typename Registry>
         inline OTF2_FlushType
-        pre_flush(void* userData, __attribute__((unused)) OTF2_FileType fileType,
-                  OTF2_LocationRef location, __attribute__((unused)) void* callerData, bool final)
+        pre_flush(void* userData, OTF2_FileType fileType, OTF2_LocationRef location,
+                  __attribute__((unused)) void* callerData, bool final)
         {
             Archive<Registry>* ar = static_cast<Archive<Registry>*>(userData);
 
+            // OTF2 flushes within the write call of the local writer on this thread
+            auto* stats = active_statistics();
+            if (stats != nullptr && fileType == OTF2_FILETYPE_EVENTS)
+            {
+                stats->flushing();
+            }
+
+            if (ar->flush_policy_ != nullptr)
+            {
+                return ar->flush_policy_->pre_flush(fileType, location, final);
+            }
+
             return ar->pre_flush_callback_(location, final);
         }
 
@@ -499,9 +910,7 @@ namespace writer
             static_assert(otf2::chrono::clock::period::num == 1,
                           "Don't mess around with the chrono stuff!");
 
-            otf2::chrono::convert convert;
-
-            return convert(ar->post_flush_callback_(location)).count();
+            return ar->clock_convert_(ar->post_flush_callback_(location)).count();
         }
     } // namespace detail
 } // namespace writer
@@ -0,0 +1,603 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_ASYNC_HPP
+#define INCLUDE_OTF2XX_WRITER_ASYNC_HPP
+
+#include <otf2xx/writer/fwd.hpp>
+#include <otf2xx/writer/local.hpp>
+
+#include <otf2xx/chrono/chrono.hpp>
+#include <otf2xx/event/events.hpp>
+#include <otf2xx/tmp/algorithm.hpp>
+#include <otf2xx/traits/event.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#ifdef OTF2XX_NON_ATOMIC_REFCOUNT
+#error "The async writer needs atomic reference counts, see OTF2XX_ATOMIC_REFCOUNT"
+#endif
+
+namespace otf2
+{
+namespace writer
+{
+    /**
+     * \brief what an async_local does, if its queue is full
+     *
+     * Enters and leaves are only dropped in pairs. A dropped enter drops everything up to its
+     * leave, and the leave of a queued enter always waits for room in the queue.
+     */
+    enum class back_pressure
+    {
+        /// wait until the background thread has made room
+        block,
+        /// drop the event
+        drop,
+        /// keep only every n-th event once the queue is half full, drop events if it is full
+        sample
+    };
+
+    namespace detail
+    {
+        /**
+         * \brief enter event without attributes, which is stored without the event object
+         */
+        struct async_enter
+        {
+            OTF2_RegionRef region;
+            otf2::chrono::time_point timestamp;
+        };
+
+        /**
+         * \brief leave event without attributes, which is stored without the event object
+         */
+        struct async_leave
+        {
+            OTF2_RegionRef region;
+            otf2::chrono::time_point timestamp;
+        };
+
+        /**
+         * \brief entry of an async queue
+         *
+         * Every event is stored by value in its slot of the queue, so the queue itself doesn't
+         * allocate per event. The copy of an event still allocates for its heap payload: the
+         * values of metric events, the arguments of program_begin events and the attribute
+         * list of any event, which has one. Enter and leave events without attributes never
+         * allocate.
+         *
+         * Each entry takes the size of the largest event, sizeof(async_record), which is about
+         * 100 bytes, while an enter event alone would take 40 bytes.
+         */
+        using async_record = otf2::tmp::apply_t<
+            otf2::tmp::concat_t<otf2::tmp::typelist<std::monostate, async_enter, async_leave>,
+                                otf2::traits::all_events>,
+            std::variant>;
+
+        /**
+         * \brief bounded lock-free queue with a single producer and a single consumer
+         */
+        class async_queue
+        {
+        public:
+            explicit async_queue(std::size_t capacity) : mask_(capacity - 1), records_(capacity)
+            {
+                assert(capacity > 0 && (capacity & mask_) == 0);
+            }
+
+            std::size_t capacity() const
+            {
+                return records_.size();
+            }
+
+            /**
+             * \brief returns the number of queued records, only exact for the producer
+             */
+            std::size_t size() const
+            {
+                return tail_.load(std::memory_order_relaxed) -
+                       head_.load(std::memory_order_acquire);
+            }
+
+            bool try_push(async_record&& record)
+            {
+                auto tail = tail_.load(std::memory_order_relaxed);
+
+                if (tail - head_cache_ > mask_)
+                {
+                    head_cache_ = head_.load(std::memory_order_acquire);
+
+                    if (tail - head_cache_ > mask_)
+                    {
+                        return false;
+                    }
+                }
+
+                records_[tail & mask_] = std::move(record);
+                tail_.store(tail + 1, std::memory_order_release);
+
+                return true;
+            }
+
+            template <typename Consumer>
+            std::size_t drain(Consumer&& consume)
+            {
+                auto head = head_.load(std::memory_order_relaxed);
+                auto tail = tail_.load(std::memory_order_acquire);
+
+                for (auto i = head; i != tail; ++i)
+                {
+                    consume(records_[i & mask_]);
+
+                    // release the definitions referred to by the event
+                    records_[i & mask_] = std::monostate();
+                    head_.store(i + 1, std::memory_order_release);
+                }
+
+                return tail - head;
+            }
+
+        private:
+            std::size_t mask_;
+            std::vector<async_record> records_;
+
+            // consumer side
+            alignas(64) std::atomic<std::size_t> head_{ 0 };
+
+            // producer side
+            alignas(64) std::atomic<std::size_t> tail_{ 0 };
+            std::size_t head_cache_ = 0;
+        };
+    } // namespace detail
+
+    class async;
+
+    /**
+     * \brief producer side of an async writer for one location
+     *
+     * Events written to this object are queued and written to the local writer by the background
+     * thread of the owning otf2::writer::async. Each async_local must only be used by one thread
+     * at a time.
+     */
+    class async_local
+    {
+    public:
+        async_local(async& owner, local& writer, std::size_t queue_size, back_pressure policy,
+                    std::size_t sample_rate)
+        : owner_(owner), writer_(writer), queue_(queue_size), policy_(policy),
+          sample_rate_(sample_rate)
+        {
+        }
+
+        async_local(const async_local&) = delete;
+        async_local& operator=(const async_local&) = delete;
+
+    public:
+        const otf2::definition::location& location()
+        {
+            return writer_.location();
+        }
+
+        /**
+         * \brief returns the number of events dropped by the back pressure policy
+         */
+        std::uint64_t dropped() const
+        {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+
+    public:
+        void write(const otf2::event::enter& data)
+        {
+            if (data.attribute_list().get() != nullptr)
+            {
+                push_enter(data, dropped_enters_);
+                return;
+            }
+
+            push_enter(detail::async_enter{ data.region_.ref().get(), data.timestamp() },
+                       dropped_enters_);
+        }
+
+        void write(const otf2::event::leave& data)
+        {
+            if (data.attribute_list().get() != nullptr)
+            {
+                push_leave(data, dropped_enters_);
+                return;
+            }
+
+            push_leave(detail::async_leave{ data.region_.ref().get(), data.timestamp() },
+                       dropped_enters_);
+        }
+
+        void write(const otf2::event::calling_context_enter& data)
+        {
+            push_enter(data, dropped_calling_context_enters_);
+        }
+
+        void write(const otf2::event::calling_context_leave& data)
+        {
+            push_leave(data, dropped_calling_context_enters_);
+        }
+
+        template <typename Event>
+        void write(const Event& data)
+        {
+            push(data);
+        }
+
+    private:
+        /**
+         * \brief queues an enter, or drops it with everything up to its leave
+         *
+         * Once an enter is dropped, all enters and leaves nested into it are dropped too, so the
+         * call stack stays balanced.
+         */
+        void push_enter(detail::async_record record, std::size_t& dropped_enters)
+        {
+            if (dropped_enters > 0)
+            {
+                ++dropped_enters;
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            if (!push(std::move(record)))
+            {
+                dropped_enters = 1;
+            }
+        }
+
+        /**
+         * \brief drops the leave of a dropped enter, but never the leave of a queued one
+         */
+        void push_leave(detail::async_record record, std::size_t& dropped_enters)
+        {
+            if (dropped_enters > 0)
+            {
+                --dropped_enters;
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            push(std::move(record), back_pressure::block);
+        }
+
+        bool push(detail::async_record record)
+        {
+            return push(std::move(record), policy_);
+        }
+
+        inline bool push(detail::async_record record, back_pressure policy);
+
+        friend class async;
+
+    private:
+        async& owner_;
+        local& writer_;
+        detail::async_queue queue_;
+        back_pressure policy_;
+        std::size_t sample_rate_;
+        std::size_t sample_counter_ = 0;
+        std::atomic<std::uint64_t> dropped_{ 0 };
+
+        // the enters dropped, whose leave is still to come
+        std::size_t dropped_enters_ = 0;
+        std::size_t dropped_calling_context_enters_ = 0;
+    };
+
+    /**
+     * \brief writes events of several locations in a background thread
+     *
+     * Every recording thread gets its own queue by calling attach() with the local writer of its
+     * location. Writing to the returned async_local only puts a record into that queue, so the
+     * recording thread never waits for OTF2 to flush its buffers. The background thread wakes up
+     * regularly, or if a queue runs full, and writes all queued events to their local writers.
+     *
+     * The local writers must not be used directly while attached, and the async writer must be
+     * destroyed before the archive. The destructor writes all remaining events.
+     */
+    class async
+    {
+    public:
+        /**
+         * \param policy what to do with events, if the queue of a location is full
+         * \param queue_size number of events each queue can hold, rounded up to a power of two.
+         *        Every location allocates queue_size * sizeof(detail::async_record) bytes up
+         *        front, about 850 kB for the default.
+         * \param interval time between two runs of the background thread
+         * \param sample_rate keep every n-th event, if the policy is back_pressure::sample
+         */
+        explicit async(back_pressure policy = back_pressure::block,
+                       std::size_t queue_size = 8 * 1024,
+                       std::chrono::milliseconds interval = std::chrono::milliseconds(10),
+                       std::size_t sample_rate = 8)
+        : policy_(policy), queue_size_(round_up(queue_size)), interval_(interval),
+          sample_rate_(sample_rate > 0 ? sample_rate : 1), thread_([this]() { run(); })
+        {
+        }
+
+        async(const async&) = delete;
+        async& operator=(const async&) = delete;
+
+        ~async()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+
+            wakeup_.notify_one();
+            thread_.join();
+        }
+
+    public:
+        /**
+         * \brief creates the queue for the given local writer
+         *
+         * This is thread-safe.
+         */
+        async_local& attach(local& writer)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            queues_.emplace_back(
+                std::make_unique<async_local>(*this, writer, queue_size_, policy_, sample_rate_));
+
+            return *queues_.back();
+        }
+
+        /**
+         * \brief blocks until all events queued before this call are written
+         *
+         * \throws the first error the background thread ran into while writing events
+         */
+        void flush()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            auto request = ++flush_requested_;
+            wakeup_.notify_one();
+
+            flushed_.wait(lock, [this, request]() { return flush_done_ >= request; });
+
+            if (error_)
+            {
+                std::rethrow_exception(error_);
+            }
+        }
+
+        /**
+         * \brief returns the number of events dropped by all queues
+         */
+        std::uint64_t dropped() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            std::uint64_t result = 0;
+            for (const auto& queue : queues_)
+            {
+                result += queue->dropped();
+            }
+
+            return result;
+        }
+
+    private:
+        friend class async_local;
+
+        void notify()
+        {
+            {
+                // otherwise, the background thread could miss the wakeup between checking the
+                // flag and starting to wait
+                std::lock_guard<std::mutex> lock(mutex_);
+                wakeup_requested_ = true;
+            }
+
+            wakeup_.notify_one();
+        }
+
+        void run()
+        {
+            std::vector<async_local*> queues;
+
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            while (true)
+            {
+                wakeup_.wait_for(lock, interval_,
+                                 [this]()
+                                 {
+                                     return stop_ || flush_done_ < flush_requested_ ||
+                                            std::exchange(wakeup_requested_, false);
+                                 });
+
+                bool stop = stop_;
+                auto request = flush_requested_;
+
+                queues.clear();
+                for (const auto& queue : queues_)
+                {
+                    queues.push_back(queue.get());
+                }
+
+                lock.unlock();
+
+                std::exception_ptr error;
+                for (auto queue : queues)
+                {
+                    drain(*queue, error);
+                }
+
+                lock.lock();
+
+                if (error && !error_)
+                {
+                    error_ = error;
+                }
+
+                flush_done_ = request;
+                flushed_.notify_all();
+
+                if (stop)
+                {
+                    break;
+                }
+            }
+        }
+
+        static void drain(async_local& queue, std::exception_ptr& error)
+        {
+            queue.queue_.drain(
+                [&queue, &error](const detail::async_record& record)
+                {
+                    try
+                    {
+                        std::visit(
+                            [&queue](const auto& event)
+                            {
+                                using event_type = std::decay_t<decltype(event)>;
+
+                                if constexpr (std::is_same_v<event_type, detail::async_enter>)
+                                {
+                                    queue.writer_.write_enter(event.timestamp, event.region);
+                                }
+                                else if constexpr (std::is_same_v<event_type, detail::async_leave>)
+                                {
+                                    queue.writer_.write_leave(event.timestamp, event.region);
+                                }
+                                else if constexpr (!std::is_same_v<event_type, std::monostate>)
+                                {
+                                    queue.writer_.write(event);
+                                }
+                            },
+                            record);
+                    }
+                    catch (...)
+                    {
+                        if (!error)
+                        {
+                            error = std::current_exception();
+                        }
+                    }
+                });
+        }
+
+        static std::size_t round_up(std::size_t size)
+        {
+            std::size_t result = 1;
+
+            while (result < size)
+            {
+                result <<= 1;
+            }
+
+            return result;
+        }
+
+    private:
+        back_pressure policy_;
+        std::size_t queue_size_;
+        std::chrono::milliseconds interval_;
+        std::size_t sample_rate_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable wakeup_;
+        std::condition_variable flushed_;
+        bool wakeup_requested_ = false;
+        bool stop_ = false;
+        std::uint64_t flush_requested_ = 0;
+        std::uint64_t flush_done_ = 0;
+        std::exception_ptr error_;
+
+        std::vector<std::unique_ptr<async_local>> queues_;
+
+        std::thread thread_;
+    };
+
+    inline bool async_local::push(detail::async_record record, back_pressure policy)
+    {
+        if (policy == back_pressure::sample && queue_.size() > queue_.capacity() / 2 &&
+            sample_counter_++ % sample_rate_ != 0)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        while (!queue_.try_push(std::move(record)))
+        {
+            if (policy != back_pressure::block)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            owner_.notify();
+            std::this_thread::yield();
+        }
+
+        // don't wait for the next interval, if the queue is filling up
+        if (queue_.size() == queue_.capacity() / 2)
+        {
+            owner_.notify();
+        }
+
+        return true;
+    }
+
+    template <typename Record>
+    async_local& operator<<(async_local& wrt, const Record& rec)
+    {
+        wrt.write(rec);
+        return wrt;
+    }
+} // namespace writer
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_WRITER_ASYNC_HPP
@@ -0,0 +1,223 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_CHUNK_POOL_HPP
+#define INCLUDE_OTF2XX_WRITER_CHUNK_POOL_HPP
+
+#include <otf2xx/exception.hpp>
+
+#include <otf2/OTF2_Callbacks.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace otf2
+{
+namespace writer
+{
+
+    /**
+     * \brief preallocated memory for the buffer chunks of an archive
+     *
+     * The pool allocates all chunks at once during construction and touches every page of them.
+     * So, no page faults happen during the measurement. With the usual first touch policy, the
+     * memory is placed on the NUMA node of the thread constructing the pool.
+     *
+     * Installed with Archive::set_memory_callbacks(), OTF2 takes its chunks from the pool instead
+     * of calling malloc. If the pool is exhausted, OTF2 fails to allocate a new chunk, which
+     * usually means, that the buffer has to be flushed earlier. The pool must outlive the archive.
+     */
+    class chunk_pool
+    {
+    public:
+        /**
+         * \param chunk_size size of every chunk, at least the chunk sizes of the archive
+         * \param max_chunks number of chunks, which are allocated up front
+         */
+        chunk_pool(std::size_t chunk_size, std::size_t max_chunks)
+        : chunk_size_(chunk_size), max_chunks_(max_chunks),
+          memory_(static_cast<char*>(
+              ::operator new(chunk_size * max_chunks, std::align_val_t(page_size)))),
+          next_(max_chunks)
+        {
+            std::memset(memory_, 0, chunk_size_ * max_chunks_);
+
+            free_.reserve(max_chunks);
+            for (std::size_t i = max_chunks; i > 0; --i)
+            {
+                free_.push_back(i - 1);
+            }
+        }
+
+        chunk_pool(const chunk_pool&) = delete;
+        chunk_pool& operator=(const chunk_pool&) = delete;
+
+        ~chunk_pool()
+        {
+            ::operator delete(memory_, std::align_val_t(page_size));
+        }
+
+    public:
+        std::size_t chunk_size() const
+        {
+            return chunk_size_;
+        }
+
+        std::size_t capacity() const
+        {
+            return max_chunks_;
+        }
+
+        /**
+         * \brief returns the number of chunks, which are currently not used by any buffer
+         */
+        std::size_t available() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return free_.size();
+        }
+
+        /**
+         * \brief limits the number of chunks a single buffer may hold
+         *
+         * If a buffer has used up its limit, OTF2 gets no further chunk and flushes the buffer
+         * instead. This keeps a few busy locations from taking all of the pool. Zero means no
+         * limit.
+         */
+        void set_buffer_limit(std::size_t chunks)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            buffer_limit_ = chunks;
+        }
+
+        /**
+         * \brief returns the memory callbacks for OTF2, the user data must point to a chunk_pool
+         */
+        static const OTF2_MemoryCallbacks* callbacks()
+        {
+            static const OTF2_MemoryCallbacks callbacks = []()
+            {
+                OTF2_MemoryCallbacks result;
+                result.otf2_allocate = allocate;
+                result.otf2_free_all = free_all;
+                return result;
+            }();
+
+            return &callbacks;
+        }
+
+    private:
+        // The chunks of a buffer are kept in a singly linked list. The per buffer data of OTF2
+        // holds the index of the last allocated chunk plus one, so null is the empty list.
+        static const std::size_t no_chunk = 0;
+
+        static void* allocate(void* user_data, OTF2_FileType, OTF2_LocationRef,
+                              void** per_buffer_data, std::uint64_t chunk_size)
+        {
+            auto& pool = *static_cast<chunk_pool*>(user_data);
+
+            if (chunk_size > pool.chunk_size_)
+            {
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(pool.mutex_);
+
+            if (pool.free_.empty() ||
+                (pool.buffer_limit_ != 0 &&
+                 pool.count_chunks(*per_buffer_data) >= pool.buffer_limit_))
+            {
+                return nullptr;
+            }
+
+            auto index = pool.free_.back();
+            pool.free_.pop_back();
+
+            pool.next_[index] = reinterpret_cast<std::uintptr_t>(*per_buffer_data);
+            *per_buffer_data = reinterpret_cast<void*>(static_cast<std::uintptr_t>(index + 1));
+
+            return pool.memory_ + index * pool.chunk_size_;
+        }
+
+        static void free_all(void* user_data, OTF2_FileType, OTF2_LocationRef,
+                             void** per_buffer_data, bool)
+        {
+            auto& pool = *static_cast<chunk_pool*>(user_data);
+
+            std::lock_guard<std::mutex> lock(pool.mutex_);
+
+            auto head = reinterpret_cast<std::uintptr_t>(*per_buffer_data);
+            while (head != no_chunk)
+            {
+                auto index = head - 1;
+                pool.free_.push_back(index);
+                head = pool.next_[index];
+            }
+
+            *per_buffer_data = nullptr;
+        }
+
+        std::size_t count_chunks(void* per_buffer_data) const
+        {
+            std::size_t result = 0;
+
+            for (auto head = reinterpret_cast<std::uintptr_t>(per_buffer_data); head != no_chunk;
+                 head = next_[head - 1])
+            {
+                ++result;
+            }
+
+            return result;
+        }
+
+    private:
+        static const std::size_t page_size = 4096;
+
+        std::size_t chunk_size_;
+        std::size_t max_chunks_;
+        char* memory_;
+
+        mutable std::mutex mutex_;
+        std::vector<std::uintptr_t> next_;
+        std::vector<std::size_t> free_;
+        std::size_t buffer_limit_ = 0;
+    };
+} // namespace writer
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_WRITER_CHUNK_POOL_HPP
@@ -0,0 +1,259 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_FILTER_HPP
+#define INCLUDE_OTF2XX_WRITER_FILTER_HPP
+
+#include <otf2xx/writer/fwd.hpp>
+#include <otf2xx/writer/local.hpp>
+
+#include <otf2xx/chrono/chrono.hpp>
+#include <otf2xx/definition/region.hpp>
+#include <otf2xx/event/enter.hpp>
+#include <otf2xx/event/leave.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace otf2
+{
+namespace writer
+{
+
+    /**
+     * \brief rules, which enter and leave events are written
+     *
+     * Regions can be included or excluded explicitly, all other regions follow the default.
+     * Additionally, calls shorter than the minimal duration are dropped.
+     */
+    class filter
+    {
+    public:
+        /**
+         * \param include_by_default whether regions without a rule are written
+         */
+        explicit filter(bool include_by_default = true) : default_(include_by_default)
+        {
+        }
+
+        filter& include(const otf2::definition::region& region)
+        {
+            set(region.ref(), true);
+            return *this;
+        }
+
+        filter& exclude(const otf2::definition::region& region)
+        {
+            set(region.ref(), false);
+            return *this;
+        }
+
+        /**
+         * \brief drops calls without kept nested events, which are shorter than the given duration
+         */
+        filter& min_duration(otf2::chrono::duration duration)
+        {
+            min_duration_ = duration;
+            return *this;
+        }
+
+        otf2::chrono::duration min_duration() const
+        {
+            return min_duration_;
+        }
+
+        bool includes(OTF2_RegionRef region) const
+        {
+            if (rules_.empty())
+            {
+                return default_;
+            }
+
+            auto it = rules_.find(region);
+            return it != rules_.end() ? it->second : default_;
+        }
+
+    private:
+        void set(OTF2_RegionRef region, bool include)
+        {
+            rules_[region] = include;
+        }
+
+    private:
+        bool default_;
+        otf2::chrono::duration min_duration_{ 0 };
+
+        // whether a region is included, keyed by its reference, which can be arbitrarily large
+        std::unordered_map<OTF2_RegionRef, bool> rules_;
+    };
+
+    /**
+     * \brief a stage in front of a local writer, which drops events by the rules of a filter
+     *
+     * Enter and leave events of excluded regions are dropped. With a minimal duration, the enter
+     * events of the current call stack are held back in a small stack per location. A call is
+     * dropped with all its nested calls, if its leave event shows, that it was too short, and
+     * none of the nested events were kept. Once a nested event is kept or a call was long
+     * enough, the held back enter events of the call and all its callers are written. So, the
+     * stream of enter and leave events stays balanced and short wrappers around only short calls
+     * vanish completely. As dropped events never reach the local writer, the event count of the
+     * location stays correct.
+     *
+     * Call flush() or destroy the stage before the local writer.
+     */
+    class filtered_local
+    {
+    public:
+        filtered_local(local& writer, const filter& rules) : writer_(writer), rules_(rules)
+        {
+        }
+
+        filtered_local(const filtered_local&) = delete;
+        filtered_local& operator=(const filtered_local&) = delete;
+
+        ~filtered_local()
+        {
+            // errors can't be reported from here, call flush() before to get them
+            try
+            {
+                flush();
+            }
+            catch (...)
+            {
+            }
+        }
+
+    public:
+        /**
+         * \brief returns the number of events dropped by the filter
+         */
+        std::uint64_t dropped() const
+        {
+            return dropped_;
+        }
+
+        /**
+         * \brief writes the held back enter events, if any
+         *
+         * The calls of the written enter events are kept, even if they turn out to be short.
+         */
+        void flush()
+        {
+            for (; written_ < stack_.size(); ++written_)
+            {
+                writer_.write(stack_[written_]);
+            }
+        }
+
+    public:
+        void write(const otf2::event::enter& data)
+        {
+            if (!rules_.includes(data.region_.ref().get()))
+            {
+                ++dropped_;
+                return;
+            }
+
+            if (rules_.min_duration() > otf2::chrono::duration(0))
+            {
+                stack_.push_back(data);
+            }
+            else
+            {
+                writer_.write(data);
+            }
+        }
+
+        void write(const otf2::event::leave& data)
+        {
+            if (!rules_.includes(data.region_.ref().get()))
+            {
+                ++dropped_;
+                return;
+            }
+
+            if (!stack_.empty() && stack_.back().region_.ref() == data.region_.ref())
+            {
+                // nothing nested was kept, or the enter event would have been written
+                if (written_ < stack_.size() &&
+                    data.timestamp() - stack_.back().timestamp() < rules_.min_duration())
+                {
+                    stack_.pop_back();
+                    dropped_ += 2;
+                    return;
+                }
+
+                flush();
+                stack_.pop_back();
+                written_ = stack_.size();
+            }
+            else
+            {
+                flush();
+            }
+
+            writer_.write(data);
+        }
+
+        template <typename Event>
+        void write(const Event& data)
+        {
+            flush();
+            writer_.write(data);
+        }
+
+    private:
+        local& writer_;
+        const filter& rules_;
+
+        // the calls entered, but not yet left, with the held back ones on top
+        std::vector<otf2::event::enter> stack_;
+
+        // the number of calls at the bottom of the stack, whose enter event was written
+        std::size_t written_ = 0;
+        std::uint64_t dropped_ = 0;
+    };
+
+    template <typename Record>
+    filtered_local& operator<<(filtered_local& wrt, const Record& rec)
+    {
+        wrt.write(rec);
+        return wrt;
+    }
+} // namespace writer
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_WRITER_FILTER_HPP
@@ -0,0 +1,436 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_FLIGHT_RECORDER_HPP
+#define INCLUDE_OTF2XX_WRITER_FLIGHT_RECORDER_HPP
+
+#include <otf2xx/writer/archive.hpp>
+#include <otf2xx/writer/fwd.hpp>
+#include <otf2xx/writer/local.hpp>
+
+#include <otf2xx/chrono/chrono.hpp>
+#include <otf2xx/definition/location.hpp>
+#include <otf2xx/event/events.hpp>
+
+#include <otf2/OTF2_AttributeList.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace otf2
+{
+namespace writer
+{
+    namespace detail
+    {
+        /**
+         * \brief heap copy of an event, which is written when the flight recorder is dumped
+         */
+        class deferred_event
+        {
+        public:
+            virtual ~deferred_event() = default;
+
+            virtual void write(local& writer) const = 0;
+        };
+
+        template <typename Event>
+        class deferred_event_impl : public deferred_event
+        {
+        public:
+            explicit deferred_event_impl(const Event& event) : event_(event)
+            {
+            }
+
+            void write(local& writer) const override
+            {
+                writer.write(event_);
+            }
+
+        private:
+            Event event_;
+        };
+
+        /**
+         * \brief returns the heap memory held by the copy of an event besides the event itself
+         *
+         * These are the values of metric events, the arguments of program_begin events and the
+         * attribute list of any event. OTF2 keeps the attributes in a list of opaque nodes, so
+         * their size is estimated by their contents and a link.
+         */
+        template <typename Event>
+        std::size_t payload_size(const Event& data)
+        {
+            std::size_t size = 0;
+
+            if (data.attribute_list().get() != nullptr)
+            {
+                std::size_t count =
+                    OTF2_AttributeList_GetNumberOfElements(data.attribute_list().get());
+
+                size += count * (sizeof(OTF2_AttributeRef) + sizeof(OTF2_Type) +
+                                 sizeof(OTF2_AttributeValue) + sizeof(void*));
+            }
+
+            if constexpr (std::is_same<Event, otf2::event::metric>::value)
+            {
+                size += data.raw_values().size() * (sizeof(OTF2_Type) + sizeof(OTF2_MetricValue));
+            }
+
+            if constexpr (std::is_same<Event, otf2::event::program_begin>::value)
+            {
+                size += data.arguments().size() * sizeof(data.arguments().front());
+            }
+
+            return size;
+        }
+
+        enum class recorder_record_type : std::uint8_t
+        {
+            enter,
+            leave,
+            other
+        };
+
+        /**
+         * \brief slot in the ring of a flight recorder
+         *
+         * Enter and leave events without attributes are stored inline, all other events are
+         * copied to the heap. The region is also kept for enter and leave events with
+         * attributes, so the call stack can be repaired on a dump.
+         */
+        struct recorder_record
+        {
+            recorder_record_type type;
+            OTF2_RegionRef region;
+            otf2::chrono::time_point timestamp;
+            deferred_event* event;
+            std::size_t event_size;
+        };
+    } // namespace detail
+
+    class flight_recorder;
+
+    /**
+     * \brief keeps the most recent events of one location in memory
+     *
+     * The events are stored in a ring of fixed size. Once the memory budget is used up, the
+     * oldest events are overwritten. The budget covers the slots of the ring, the heap copies of
+     * the events not stored inline and their payloads, like metric values and attributes.
+     * Nothing is written to the archive, until the owning otf2::writer::flight_recorder is
+     * dumped.
+     */
+    class flight_recorder_local
+    {
+    public:
+        flight_recorder_local(const otf2::definition::location& location, std::size_t budget)
+        : location_(location), budget_(budget),
+          slots_(std::max<std::size_t>(budget / sizeof(detail::recorder_record), 1))
+        {
+        }
+
+        flight_recorder_local(const flight_recorder_local&) = delete;
+        flight_recorder_local& operator=(const flight_recorder_local&) = delete;
+
+        ~flight_recorder_local()
+        {
+            clear();
+        }
+
+    public:
+        const otf2::definition::location& location() const
+        {
+            return location_;
+        }
+
+        /**
+         * \brief returns the number of events, which were overwritten by newer ones
+         */
+        std::uint64_t overwritten() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return overwritten_;
+        }
+
+        /**
+         * \brief returns the number of events currently held
+         */
+        std::size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return size_;
+        }
+
+    public:
+        void write(const otf2::event::enter& data)
+        {
+            if (data.attribute_list().get() != nullptr)
+            {
+                write_deferred(detail::recorder_record_type::enter, data.region_.ref().get(), data);
+                return;
+            }
+
+            push({ detail::recorder_record_type::enter, data.region_.ref().get(), data.timestamp(),
+                   nullptr, 0 });
+        }
+
+        void write(const otf2::event::leave& data)
+        {
+            if (data.attribute_list().get() != nullptr)
+            {
+                write_deferred(detail::recorder_record_type::leave, data.region_.ref().get(), data);
+                return;
+            }
+
+            push({ detail::recorder_record_type::leave, data.region_.ref().get(), data.timestamp(),
+                   nullptr, 0 });
+        }
+
+        template <typename Event>
+        void write(const Event& data)
+        {
+            write_deferred(detail::recorder_record_type::other, 0, data);
+        }
+
+    private:
+        template <typename Event>
+        void write_deferred(detail::recorder_record_type type, OTF2_RegionRef region,
+                            const Event& data)
+        {
+            push({ type, region, data.timestamp(), new detail::deferred_event_impl<Event>(data),
+                   sizeof(detail::deferred_event_impl<Event>) + detail::payload_size(data) });
+        }
+
+        void push(const detail::recorder_record& record)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // the used slots and the heap copies of the held events share the budget
+            while (size_ > 0 && (size_ == slots_.size() ||
+                                 (size_ + 1) * sizeof(detail::recorder_record) + heap_used_ +
+                                         record.event_size >
+                                     budget_))
+            {
+                pop_front();
+                ++overwritten_;
+            }
+
+            slots_[(head_ + size_) % slots_.size()] = record;
+            heap_used_ += record.event_size;
+            ++size_;
+        }
+
+        void pop_front()
+        {
+            auto& record = slots_[head_];
+
+            delete record.event;
+            heap_used_ -= record.event_size;
+
+            head_ = (head_ + 1) % slots_.size();
+            --size_;
+        }
+
+        void clear()
+        {
+            while (size_ > 0)
+            {
+                pop_front();
+            }
+        }
+
+        /**
+         * \brief writes all held events to the given writer and empties the ring
+         *
+         * Leave events, whose enter was overwritten, are skipped. Regions, which are still
+         * entered at the end, are left at the timestamp of the last event.
+         */
+        void dump(local& writer)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            std::vector<OTF2_RegionRef> stack;
+            otf2::chrono::time_point last = otf2::chrono::time_point::min();
+
+            for (std::size_t i = 0; i < size_; ++i)
+            {
+                const auto& record = slots_[(head_ + i) % slots_.size()];
+
+                if (record.type == detail::recorder_record_type::leave)
+                {
+                    if (stack.empty())
+                    {
+                        continue;
+                    }
+
+                    stack.pop_back();
+                }
+                else if (record.type == detail::recorder_record_type::enter)
+                {
+                    stack.push_back(record.region);
+                }
+
+                last = record.timestamp;
+
+                if (record.event != nullptr)
+                {
+                    record.event->write(writer);
+                }
+                else if (record.type == detail::recorder_record_type::enter)
+                {
+                    writer.write_enter(record.timestamp, record.region);
+                }
+                else
+                {
+                    writer.write_leave(record.timestamp, record.region);
+                }
+            }
+
+            while (!stack.empty())
+            {
+                writer.write_leave(last, stack.back());
+                stack.pop_back();
+            }
+
+            clear();
+        }
+
+        friend class flight_recorder;
+
+    private:
+        otf2::definition::location location_;
+        std::size_t budget_;
+
+        mutable std::mutex mutex_;
+        std::vector<detail::recorder_record> slots_;
+        std::size_t head_ = 0;
+        std::size_t size_ = 0;
+        std::size_t heap_used_ = 0;
+        std::uint64_t overwritten_ = 0;
+    };
+
+    /**
+     * \brief keeps the most recent events of several locations in memory for always-on tracing
+     *
+     * Every location gets a ring with a fixed memory budget by calling attach(). Events written
+     * to it overwrite the oldest ones, once the budget is used up. Nothing touches the archive
+     * or the file system, until dump() is called, e.g. when an error is detected.
+     *
+     * dump() writes the held events through the local writers of the given archive. The
+     * definitions are written as usual by the archive, so the dumped trace is valid with the
+     * correct number of events per location, once the archive is closed.
+     *
+     * Each flight_recorder_local must only be written by one thread at a time, but dump() may be
+     * called from any thread.
+     */
+    class flight_recorder
+    {
+    public:
+        /**
+         * \param budget memory for the events of each location in bytes
+         */
+        explicit flight_recorder(std::size_t budget = 16 * 1024 * 1024) : budget_(budget)
+        {
+        }
+
+        flight_recorder(const flight_recorder&) = delete;
+        flight_recorder& operator=(const flight_recorder&) = delete;
+
+    public:
+        /**
+         * \brief creates the ring for the given location
+         *
+         * This is thread-safe.
+         */
+        flight_recorder_local& attach(const otf2::definition::location& location)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            locals_.emplace_back(std::make_unique<flight_recorder_local>(location, budget_));
+
+            return *locals_.back();
+        }
+
+        /**
+         * \brief writes the held events of all locations to the archive and empties the rings
+         */
+        template <typename Registry>
+        void dump(Archive<Registry>& ar)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            for (auto& local : locals_)
+            {
+                local->dump(ar(local->location()));
+            }
+        }
+
+        /**
+         * \brief returns the number of events overwritten in all rings
+         */
+        std::uint64_t overwritten() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            std::uint64_t result = 0;
+            for (const auto& local : locals_)
+            {
+                result += local->overwritten();
+            }
+
+            return result;
+        }
+
+    private:
+        std::size_t budget_;
+
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<flight_recorder_local>> locals_;
+    };
+
+    template <typename Record>
+    flight_recorder_local& operator<<(flight_recorder_local& wrt, const Record& rec)
+    {
+        wrt.write(rec);
+        return wrt;
+    }
+} // namespace writer
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_WRITER_FLIGHT_RECORDER_HPP
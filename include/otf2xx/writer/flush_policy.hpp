@@ -0,0 +1,201 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_FLUSH_POLICY_HPP
+#define INCLUDE_OTF2XX_WRITER_FLUSH_POLICY_HPP
+
+#include <otf2xx/chrono/chrono.hpp>
+#include <otf2xx/definition/location.hpp>
+#include <otf2xx/exception.hpp>
+#include <otf2xx/reference.hpp>
+
+#include <otf2/OTF2_Callbacks.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace otf2
+{
+namespace writer
+{
+
+    /**
+     * \brief coordinates the buffer flushes of all locations of an archive
+     *
+     * Installed with Archive::set_flush_policy(), every flush has to get one of a limited number
+     * of slots before it may write to the file system. So, if thousands of threads fill their
+     * buffers at the same time, they take turns instead of hitting the file system all at once.
+     *
+     * The policy installs the post flush callback, so OTF2 records every flush as buffer_flush
+     * event, from the time the buffer got full until the time it is written. The latter is taken
+     * from the given time source, so it has to use the same clock as the events.
+     *
+     * Combined with chunk_pool::set_buffer_limit(), the memory of busy locations is capped, so
+     * they flush early and leave the pool to the quieter locations.
+     */
+    class flush_policy
+    {
+    public:
+        using time_source = std::function<otf2::chrono::time_point()>;
+
+        /**
+         * \param now returns the current time for the stop time of the buffer_flush events
+         * \param max_concurrent_flushes number of flushes allowed to run at the same time
+         */
+        explicit flush_policy(time_source now, std::size_t max_concurrent_flushes = 4)
+        : now_(std::move(now)), slots_(max_concurrent_flushes)
+        {
+            if (!now_)
+            {
+                make_exception("A flush policy needs a time source");
+            }
+
+            if (max_concurrent_flushes == 0)
+            {
+                make_exception("A flush policy needs at least one concurrent flush");
+            }
+        }
+
+        flush_policy(const flush_policy&) = delete;
+        flush_policy& operator=(const flush_policy&) = delete;
+
+    public:
+        /**
+         * \brief returns the number of intermediate flushes of event buffers so far
+         */
+        std::uint64_t flushes() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return flushes_;
+        }
+
+        /**
+         * \brief returns the number of flushes, which had to wait for another flush to finish
+         */
+        std::uint64_t delayed_flushes() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return delayed_flushes_;
+        }
+
+        /**
+         * \brief returns the total time spent in flushes, including the waiting for a slot
+         */
+        std::chrono::nanoseconds flush_time() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return flush_time_;
+        }
+
+    public:
+        /**
+         * \brief waits for a free slot, called by OTF2 before a buffer is flushed
+         *
+         * Only intermediate flushes of event buffers take a slot. OTF2 calls post_flush() only
+         * for these, so the flushes of definition buffers and the final flushes on close pass
+         * right away.
+         */
+        OTF2_FlushType pre_flush(OTF2_FileType file_type,
+                                 otf2::reference<otf2::definition::location>, bool final)
+        {
+            if (file_type != OTF2_FILETYPE_EVENTS || final)
+            {
+                return OTF2_FLUSH;
+            }
+
+            // the flush ends on the same thread, in post_flush()
+            flush_start() = std::chrono::steady_clock::now();
+
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            if (slots_ == 0)
+            {
+                ++delayed_flushes_;
+                slot_released_.wait(lock, [this]() { return slots_ > 0; });
+            }
+
+            --slots_;
+            ++flushes_;
+
+            return OTF2_FLUSH;
+        }
+
+        /**
+         * \brief releases the slot, called by OTF2 after a buffer was flushed
+         *
+         * \returns the stop time of the buffer_flush event
+         */
+        otf2::chrono::time_point post_flush(otf2::reference<otf2::definition::location>)
+        {
+            auto stop = now_();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                ++slots_;
+                flush_time_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - flush_start());
+            }
+
+            slot_released_.notify_one();
+
+            return stop;
+        }
+
+    private:
+        static std::chrono::steady_clock::time_point& flush_start()
+        {
+            thread_local std::chrono::steady_clock::time_point start;
+            return start;
+        }
+
+    private:
+        time_source now_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable slot_released_;
+        std::size_t slots_;
+
+        std::uint64_t flushes_ = 0;
+        std::uint64_t delayed_flushes_ = 0;
+        std::chrono::nanoseconds flush_time_{ 0 };
+    };
+} // namespace writer
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_WRITER_FLUSH_POLICY_HPP
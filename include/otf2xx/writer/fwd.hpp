@@ -64,6 +64,33 @@ namespace writer
     class global;
 
     class local;
+    class raw_local;
+
+    class async;
+    class async_local;
+    class flight_recorder;
+    class flight_recorder_local;
+    class chunk_pool;
+    class flush_policy;
+    class filter;
+    class filtered_local;
+    class profile;
+    class unification;
+
+    template <typename Registry>
+    class Rewriter;
+
+    using rewriter = Rewriter<otf2::registry>;
+
+    template <typename Registry>
+    class Merger;
+
+    using merger = Merger<otf2::registry>;
+
+    template <typename Registry>
+    class Splitter;
+
+    using splitter = Splitter<otf2::registry>;
 
     template <typename Record>
     local& operator<<(local& wrt, Record evt);
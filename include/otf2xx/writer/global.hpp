@@ -47,6 +47,8 @@
 
 #include <algorithm>
 #include <limits>
+#include <map>
+#include <vector>
 
 namespace otf2
 {
@@ -57,8 +59,15 @@ namespace writer
     class global
     {
     public:
-        global(OTF2_GlobalDefWriter* wrt, OTF2_MarkerWriter* marker_wrt)
-        : wrt(wrt), marker_wrt_(marker_wrt)
+        /**
+         * \brief creates the global writer
+         *
+         * The convert object is shared with the local writers of the archive. It's reconfigured,
+         * once the clock properties are written.
+         */
+        global(OTF2_GlobalDefWriter* wrt, OTF2_MarkerWriter* marker_wrt,
+               otf2::chrono::convert& clock_convert)
+        : wrt(wrt), marker_wrt_(marker_wrt), clock_convert_(clock_convert)
         {
         }
 
@@ -142,7 +151,7 @@ namespace writer
         template <typename T, otf2::common::group_type GroupType>
         void store(const otf2::definition::group<T, GroupType>& data)
         {
-            auto members = data.members();
+            const auto& members = data.members();
             check(OTF2_GlobalDefWriter_WriteGroup(
                       wrt, data.ref(), data.name().ref(), static_cast<OTF2_GroupType>(data.type()),
                       static_cast<OTF2_Paradigm>(data.paradigm()),
@@ -152,34 +161,22 @@ namespace writer
 
         void store(const otf2::definition::comm_group& data)
         {
-            auto members = data.members();
-
             // find corresponding group
-            otf2::definition::comm_locations_group cgroup;
-            for (auto group : reg_.template all<otf2::definition::comm_locations_group>())
+            auto cgroup = comm_locations_groups_.find(data.paradigm());
+
+            if (cgroup == comm_locations_groups_.end())
             {
-                if (group.paradigm() == data.paradigm())
-                {
-                    cgroup = group;
-                }
+                make_exception("Couldn't find the comm locations group for the comm group #",
+                               data.ref());
             }
 
-            assert(cgroup.is_valid());
-
-            auto cmembers = cgroup.members();
-
-            // FIXME O(n^2) doesn't scale to millions of cores
             // translate members relative to cgroup
-            for (std::size_t i = 0; i < members.size(); ++i)
+            std::vector<std::uint64_t> members;
+            members.reserve(data.size());
+
+            for (auto member : data.members())
             {
-                for (std::size_t j = 0; j < cmembers.size(); ++j)
-                {
-                    if (members[i] == cmembers[j])
-                    {
-                        members[i] = j;
-                        break;
-                    }
-                }
+                members.push_back(cgroup->second.index_of(member));
             }
 
             check(OTF2_GlobalDefWriter_WriteGroup(
@@ -543,6 +540,14 @@ namespace writer
             store(reg.template all<otf2::definition::location_property>().data());
             store(reg.template all<otf2::definition::region>().data());
 
+            // comm groups are written as ranks in the comm locations group of their paradigm,
+            // which in turn keeps an index from locations to ranks
+            comm_locations_groups_.clear();
+            for (const auto& group : reg.template all<otf2::definition::comm_locations_group>())
+            {
+                comm_locations_groups_[group.paradigm()] = group;
+            }
+
             store(reg.template all<otf2::definition::comm_locations_group>().data(),
                   reg.template all<otf2::definition::comm_self_group>().data(),
                   reg.template all<otf2::definition::comm_group>().data(),
@@ -583,9 +588,86 @@ namespace writer
         }
 
     public:
+        /**
+         * \brief writes buffered definitions right away and drops them from the registry
+         *
+         * This allows long-running writers to release the memory of their definitions
+         * continuously, instead of buffering all of them until the destruction of the writer.
+         * The definitions are written in the same order as at destruction, so every definition
+         * follows the ones it refers to.
+         *
+         * Locations are kept back, because their number of events is only known at the end. So
+         * are all definitions, which may refer to locations, i.e. groups, comms and everything
+         * built on top of them, as well as metric classes and instances. These are written on
+         * destruction.
+         *
+         * The clock properties are written by the first flush after they were set, and can't be
+         * changed afterwards. Set them before the first flush to keep them in front of all other
+         * definitions.
+         *
+         * \note The registry only keeps the references of flushed definitions, so their memory is
+         *       released. Lookups by reference or key, has() and emplace() still find them, but
+         *       return a definition, which only carries the reference. It can still be used by
+         *       events, but its data can't be accessed anymore. Defining a flushed reference
+         *       again with create() or by writing a definition throws, as the trace would get the
+         *       definition twice.
+         */
+        void flush()
+        {
+            if (clock_properties_set_ && !clock_properties_written_)
+            {
+                store(clock_properties_);
+                clock_properties_written_ = true;
+            }
+
+            store(reg_.template take<otf2::definition::string>());
+            store(reg_.template take<otf2::definition::attribute>());
+            store(reg_.template take<otf2::definition::system_tree_node>());
+            store(reg_.template take<otf2::definition::system_tree_node_property>());
+            store(reg_.template take<otf2::definition::system_tree_node_domain>());
+            store(reg_.template take<otf2::definition::location_group>());
+            store(reg_.template take<otf2::definition::location_group_property>());
+            store(reg_.template take<otf2::definition::region>());
+
+            store(reg_.template take<otf2::definition::parameter>());
+            store(reg_.template take<otf2::definition::call_path>());
+            store(reg_.template take<otf2::definition::call_path_parameter>());
+
+            store(reg_.template take<otf2::definition::source_code_location>());
+            store(reg_.template take<otf2::definition::calling_context>());
+            store(reg_.template take<otf2::definition::calling_context_property>());
+            store(reg_.template take<otf2::definition::interrupt_generator>());
+
+            store(reg_.template take<otf2::definition::metric_member>());
+
+            store(reg_.template take<otf2::definition::io_paradigm>());
+            store(reg_.template take<otf2::definition::io_directory>(),
+                  reg_.template take<otf2::definition::io_regular_file>());
+            store(reg_.template take<otf2::definition::io_file_property>());
+
+            store(reg_.template take<otf2::definition::marker>());
+        }
+
+    public:
+        /**
+         * \brief sets the clock properties of the trace
+         *
+         * From now on, the timestamps of all events are converted to ticks of this clock. So, this
+         * should be written before any event.
+         *
+         * \note The epoch of the time points is kept, i.e. the start time of the clock properties
+         *       isn't added to the converted timestamps.
+         */
         void write(otf2::definition::clock_properties data)
         {
+            if (clock_properties_written_)
+            {
+                make_exception("The clock properties were already written by a flush");
+            }
+
             clock_properties_ = data;
+            clock_properties_set_ = true;
+            clock_convert_ = otf2::chrono::convert(data.ticks_per_second());
         }
 
         template <typename Definition>
@@ -599,12 +681,11 @@ namespace writer
     public:
         void write(otf2::event::marker evt)
         {
-            otf2::chrono::convert cvrt;
-
             static_assert(otf2::chrono::clock::period::num == 1,
                           "Don't mess around with the chrono stuff!");
 
-            check(OTF2_MarkerWriter_WriteMarker(marker_wrt_, cvrt(evt.timestamp()).count(),
+            check(OTF2_MarkerWriter_WriteMarker(marker_wrt_,
+                                                clock_convert_(evt.timestamp()).count(),
                                                 evt.duration().count(), evt.def_marker().ref(),
                                                 static_cast<OTF2_MarkerScope>(evt.scope()),
                                                 evt.scope_ref(), evt.text().c_str()),
@@ -620,7 +701,10 @@ namespace writer
         ~global()
         {
             // call real writes in correct order
-            store(clock_properties_);
+            if (!clock_properties_written_)
+            {
+                store(clock_properties_);
+            }
             store(reg_);
         }
 
@@ -631,6 +715,12 @@ namespace writer
         Registry reg_;
 
         otf2::definition::clock_properties clock_properties_;
+        bool clock_properties_set_ = false;
+        bool clock_properties_written_ = false;
+        otf2::chrono::convert& clock_convert_;
+
+        std::map<otf2::common::paradigm_type, otf2::definition::comm_locations_group>
+            comm_locations_groups_;
     };
 
     template <typename Definition, typename Registry>
@@ -45,18 +45,37 @@
 #include <otf2xx/chrono/chrono.hpp>
 #include <otf2xx/chrono/convert.hpp>
 
+#include <otf2xx/writer/profile.hpp>
+#include <otf2xx/writer/statistics.hpp>
+
+#include <array>
+#include <chrono>
+#include <memory>
+
 namespace otf2
 {
 namespace writer
 {
 
+    class raw_local;
+
     class local
     {
     public:
         local(OTF2_Archive* ar, const otf2::definition::location& location)
-        : location_(location), ar_(ar), def_wrt_(OTF2_Archive_GetDefWriter(ar, location.ref())),
-          evt_wrt_(OTF2_Archive_GetEvtWriter(ar, location.ref()))
+        : local(ar, location, default_convert())
+        {
+        }
 
+        /**
+         * \brief creates a local writer, which converts timestamps with the given object
+         *
+         * The writer keeps a reference to the convert object, so it has to outlive the writer.
+         */
+        local(OTF2_Archive* ar, const otf2::definition::location& location,
+              const otf2::chrono::convert& cvrt)
+        : location_(location), ar_(ar), def_wrt_(OTF2_Archive_GetDefWriter(ar, location.ref())),
+          evt_wrt_(OTF2_Archive_GetEvtWriter(ar, location.ref())), convert_(&cvrt)
         {
             if (evt_wrt_ == nullptr)
             {
@@ -72,7 +91,10 @@ namespace writer
         local& operator=(const local&) = delete;
 
         local(local&& other)
-        : location_(std::move(other.location_)), ar_(nullptr), def_wrt_(nullptr), evt_wrt_(nullptr)
+        : location_(std::move(other.location_)), ar_(nullptr), def_wrt_(nullptr), evt_wrt_(nullptr),
+          convert_(other.convert_), profile_(std::move(other.profile_)),
+          statistics_(std::move(other.statistics_)),
+          statistics_metrics_(std::move(other.statistics_metrics_))
         {
             using std::swap;
 
@@ -90,6 +112,10 @@ namespace writer
             swap(ar_, other.ar_);
             swap(def_wrt_, other.def_wrt_);
             swap(evt_wrt_, other.evt_wrt_);
+            convert_ = other.convert_;
+            profile_ = std::move(other.profile_);
+            statistics_ = std::move(other.statistics_);
+            statistics_metrics_ = std::move(other.statistics_metrics_);
 
             return *this;
         }
@@ -98,6 +124,28 @@ namespace writer
         {
             if (ar_ != nullptr)
             {
+                // errors of the profile and the statistics can't be reported from here, call
+                // close_event_writer() before to get them
+                if (profile_ && evt_wrt_ != nullptr)
+                {
+                    try
+                    {
+                        write_profile();
+                    }
+                    catch (...)
+                    {
+                    }
+                }
+                if (statistics_ && evt_wrt_ != nullptr)
+                {
+                    try
+                    {
+                        write_statistics();
+                    }
+                    catch (...)
+                    {
+                    }
+                }
                 if (def_wrt_ != nullptr)
                 {
                     check(OTF2_Archive_CloseDefWriter(ar_, def_wrt_),
@@ -105,8 +153,7 @@ namespace writer
                 }
                 if (evt_wrt_ != nullptr)
                 {
-                    check(OTF2_Archive_CloseEvtWriter(ar_, evt_wrt_),
-                          "Couldn't close event writer");
+                    close_evt_writer();
                 }
             }
         }
@@ -142,48 +189,141 @@ namespace writer
         {
             if (evt_wrt_ != nullptr)
             {
-                check(OTF2_Archive_CloseEvtWriter(ar_, evt_wrt_), "Couldn't close event writer");
+                if (profile_)
+                {
+                    write_profile();
+                }
+                if (statistics_)
+                {
+                    write_statistics();
+                }
+
+                close_evt_writer();
 
                 evt_wrt_ = nullptr;
             }
         }
 
+    public:
+        /**
+         * \brief switches this writer from tracing to profiling
+         *
+         * From now on, enter, leave and metric events are aggregated to a call-path profile
+         * instead of being written. The profile is written, when the event writer is closed. All
+         * other events are still written as they are, so they shouldn't be later than the last
+         * profiled event. Events written through raw() bypass the profile.
+         *
+         * \param summary metric class of the profile, see otf2::writer::profile
+         * \throws if this writer is already profiling, as its profile would be lost
+         */
+        void enable_profiling(const otf2::definition::metric_class& summary)
+        {
+            if (profile_)
+            {
+                make_exception("The local writer is already profiling");
+            }
+
+            profile_ = std::make_unique<otf2::writer::profile>(summary);
+        }
+
+        bool profiling() const
+        {
+            return static_cast<bool>(profile_);
+        }
+
+    public:
+        /**
+         * \brief starts counting the events, flushes and time spent in OTF2 of this writer
+         *
+         * Once enabled, every OTF2 call writing events is timed, so this costs two clock reads
+         * per event. The counters can be read with statistics() from any thread.
+         */
+        void enable_statistics()
+        {
+            if (!statistics_)
+            {
+                statistics_ = std::make_unique<otf2::writer::statistics>();
+            }
+        }
+
+        /**
+         * \brief starts counting and writes the counters to the trace, when the writer is closed
+         *
+         * \param metrics metric class like the one of otf2::writer::statistics::make_metrics()
+         */
+        void enable_statistics(const otf2::definition::metric_class& metrics)
+        {
+            if (metrics.size() != 4)
+            {
+                make_exception("The metric class of the statistics needs four members");
+            }
+
+            enable_statistics();
+            statistics_metrics_ = metrics;
+        }
+
+        /**
+         * \brief returns the counters of this writer, or nullptr, if they aren't enabled
+         */
+        const otf2::writer::statistics* statistics() const
+        {
+            return statistics_.get();
+        }
+
     public:
         void write(const otf2::event::buffer_flush& data)
         {
-            check(OTF2_EvtWriter_BufferFlush(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_BufferFlush(evt_writer(), data.attribute_list().get(),
                                              convert(data.timestamp()), convert(data.finish())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::enter& data)
         {
-            check(OTF2_EvtWriter_Enter(evt_wrt_, data.attribute_list().get(),
+            if (profile_)
+            {
+                profile_->enter(data.timestamp(), data.region_.ref().get());
+                return;
+            }
+
+            check(OTF2_EvtWriter_Enter(evt_writer(), data.attribute_list().get(),
                                        convert(data.timestamp()), data.region_.ref().get()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::leave& data)
         {
-            check(OTF2_EvtWriter_Leave(evt_wrt_, data.attribute_list().get(),
+            if (profile_)
+            {
+                profile_->leave(data.timestamp(), data.region_.ref().get());
+                return;
+            }
+
+            check(OTF2_EvtWriter_Leave(evt_writer(), data.attribute_list().get(),
                                        convert(data.timestamp()), data.region_.ref().get()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::measurement& data)
         {
-            check(OTF2_EvtWriter_MeasurementOnOff(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_MeasurementOnOff(evt_writer(), data.attribute_list().get(),
                                                   convert(data.timestamp()),
                                                   static_cast<OTF2_MeasurementMode>(data.mode())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::metric& metric)
         {
+            if (profile_)
+            {
+                profile_->metric(metric);
+                return;
+            }
+
             std::size_t num_members = metric.raw_values().size();
             const auto& type_ids = metric.raw_values().type_ids();
             const auto& metric_values = metric.raw_values().values();
@@ -191,13 +331,13 @@ namespace writer
             std::visit(
                 [&](auto&& metric_ref)
                 {
-                    check(OTF2_EvtWriter_Metric(evt_wrt_, metric.attribute_list().get(),
+                    check(OTF2_EvtWriter_Metric(evt_writer(), metric.attribute_list().get(),
                                                 convert(metric.timestamp()), metric_ref.ref(),
                                                 num_members, type_ids.data(), metric_values.data()),
                           "Couldn't write event to local event writer.");
                 },
                 metric.metric_);
-            location_.event_written();
+            written(metric);
         }
 
     public:
@@ -206,22 +346,22 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_MpiIrecv(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_MpiIrecv(evt_writer(), data.attribute_list().get(),
                                                   convert(data.timestamp()), data.sender(),
                                                   comm.ref(), data.msg_tag(), data.msg_length(),
                                                   data.request_id()),
                           "Couldn't write event to local event writer.");
                 },
                 data.comm_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::mpi_ireceive_request& data)
         {
-            check(OTF2_EvtWriter_MpiIrecvRequest(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_MpiIrecvRequest(evt_writer(), data.attribute_list().get(),
                                                  convert(data.timestamp()), data.request_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::mpi_isend_request& data)
@@ -229,22 +369,22 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_MpiIsend(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_MpiIsend(evt_writer(), data.attribute_list().get(),
                                                   convert(data.timestamp()), data.receiver(),
                                                   comm.ref(), data.msg_tag(), data.msg_length(),
                                                   data.request_id()),
                           "Couldn't write event to local event writer.");
                 },
                 data.comm_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::mpi_isend_complete& data)
         {
-            check(OTF2_EvtWriter_MpiIsendComplete(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_MpiIsendComplete(evt_writer(), data.attribute_list().get(),
                                                   convert(data.timestamp()), data.request_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::mpi_receive& data)
@@ -252,29 +392,29 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_MpiRecv(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_MpiRecv(evt_writer(), data.attribute_list().get(),
                                                  convert(data.timestamp()), data.sender(),
                                                  comm.ref(), data.msg_tag(), data.msg_length()),
                           "Couldn't write event to local event writer.");
                 },
                 data.comm_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::mpi_request_test& data)
         {
-            check(OTF2_EvtWriter_MpiRequestTest(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_MpiRequestTest(evt_writer(), data.attribute_list().get(),
                                                 convert(data.timestamp()), data.request_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::mpi_request_cancelled& data)
         {
-            check(OTF2_EvtWriter_MpiRequestCancelled(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_MpiRequestCancelled(evt_writer(), data.attribute_list().get(),
                                                      convert(data.timestamp()), data.request_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::mpi_send& data)
@@ -282,21 +422,21 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_MpiSend(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_MpiSend(evt_writer(), data.attribute_list().get(),
                                                  convert(data.timestamp()), data.receiver(),
                                                  comm.ref(), data.msg_tag(), data.msg_length()),
                           "Couldn't write event to local event writer.");
                 },
                 data.comm_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::mpi_collective_begin& data)
         {
-            check(OTF2_EvtWriter_MpiCollectiveBegin(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_MpiCollectiveBegin(evt_writer(), data.attribute_list().get(),
                                                     convert(data.timestamp())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::mpi_collective_end& data)
@@ -305,22 +445,22 @@ namespace writer
                 [&](auto&& comm)
                 {
                     check(OTF2_EvtWriter_MpiCollectiveEnd(
-                              evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                              evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                               static_cast<OTF2_CollectiveOp>(data.type()), comm.ref(), data.root(),
                               data.sent(), data.received()),
                           "Couldn't write event to local event writer.");
                 },
                 data.comm_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::non_blocking_collective_request& data)
         {
-            check(OTF2_EvtWriter_NonBlockingCollectiveRequest(evt_wrt_, data.attribute_list().get(),
-                                                              convert(data.timestamp()),
-                                                              data.request_id()),
+            check(OTF2_EvtWriter_NonBlockingCollectiveRequest(
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
+                      data.request_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::non_blocking_collective_complete& data)
@@ -329,13 +469,13 @@ namespace writer
                 [&](auto&& comm)
                 {
                     check(OTF2_EvtWriter_NonBlockingCollectiveComplete(
-                              evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                              evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                               static_cast<OTF2_CollectiveOp>(data.type()), comm.ref(), data.root(),
                               data.sent(), data.received(), data.request_id()),
                           "Couldn't write event to local event writer.");
                 },
                 data.comm_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::comm_create& data)
@@ -343,12 +483,12 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_CommCreate(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_CommCreate(evt_writer(), data.attribute_list().get(),
                                                     convert(data.timestamp()), comm.ref()),
                           "Couldn't write event to local event writer.");
                 },
                 data.comm_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::comm_destroy& data)
@@ -356,68 +496,68 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_CommDestroy(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_CommDestroy(evt_writer(), data.attribute_list().get(),
                                                      convert(data.timestamp()), comm.ref()),
                           "Couldn't write event to local event writer.");
                 },
                 data.comm_);
-            location_.event_written();
+            written(data);
         }
 
     public:
         void write(const otf2::event::parameter_int& data)
         {
-            check(OTF2_EvtWriter_ParameterInt(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_ParameterInt(evt_writer(), data.attribute_list().get(),
                                               convert(data.timestamp()), data.parameter_.ref(),
                                               data.value()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::parameter_unsigned_int& data)
         {
-            check(OTF2_EvtWriter_ParameterUnsignedInt(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_ParameterUnsignedInt(evt_writer(), data.attribute_list().get(),
                                                       convert(data.timestamp()),
                                                       data.parameter_.ref(), data.value()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::parameter_string& data)
         {
-            check(OTF2_EvtWriter_ParameterString(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_ParameterString(evt_writer(), data.attribute_list().get(),
                                                  convert(data.timestamp()), data.parameter_.ref(),
                                                  data.value_.ref()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::calling_context_enter& data)
         {
             check(OTF2_EvtWriter_CallingContextEnter(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       data.calling_context_.ref(), data.unwind_distance()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::calling_context_leave& data)
         {
-            check(OTF2_EvtWriter_CallingContextLeave(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_CallingContextLeave(evt_writer(), data.attribute_list().get(),
                                                      convert(data.timestamp()),
                                                      data.calling_context_.ref()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::calling_context_sample& data)
         {
             check(OTF2_EvtWriter_CallingContextSample(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       data.calling_context_.ref(), data.unwind_distance(),
                       data.interrupt_generator_.ref()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
     public:
@@ -426,79 +566,184 @@ namespace writer
         void write_calling_context_enter(otf2::chrono::time_point timestamp,
                                          OTF2_CallingContextRef ref, uint32_t unwind_distance)
         {
-            check(OTF2_EvtWriter_CallingContextEnter(evt_wrt_, nullptr, convert(timestamp), ref,
+            check(OTF2_EvtWriter_CallingContextEnter(evt_writer(), nullptr, convert(timestamp), ref,
                                                      unwind_distance),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written_at<otf2::event::calling_context_enter>(timestamp);
         }
 
         void write_calling_context_leave(otf2::chrono::time_point timestamp,
                                          OTF2_CallingContextRef ref)
         {
-            check(OTF2_EvtWriter_CallingContextLeave(evt_wrt_, nullptr, convert(timestamp), ref),
+            check(OTF2_EvtWriter_CallingContextLeave(evt_writer(), nullptr, convert(timestamp),
+                                                     ref),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written_at<otf2::event::calling_context_leave>(timestamp);
         }
 
         void write_calling_context_sample(otf2::chrono::time_point timestamp,
                                           OTF2_CallingContextRef ref, uint32_t unwind_distance,
                                           OTF2_InterruptGeneratorRef interrupt_generator_ref)
         {
-            check(OTF2_EvtWriter_CallingContextSample(evt_wrt_, nullptr, convert(timestamp), ref,
-                                                      unwind_distance, interrupt_generator_ref),
+            check(OTF2_EvtWriter_CallingContextSample(evt_writer(), nullptr, convert(timestamp),
+                                                      ref, unwind_distance,
+                                                      interrupt_generator_ref),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written_at<otf2::event::calling_context_sample>(timestamp);
         }
 
         void write_enter(otf2::chrono::time_point timestamp, OTF2_RegionRef ref)
         {
-            check(OTF2_EvtWriter_Enter(evt_wrt_, nullptr, convert(timestamp), ref),
+            if (profile_)
+            {
+                profile_->enter(timestamp, ref);
+                return;
+            }
+
+            check(OTF2_EvtWriter_Enter(evt_writer(), nullptr, convert(timestamp), ref),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written_at<otf2::event::enter>(timestamp);
         }
 
         void write_leave(otf2::chrono::time_point timestamp, OTF2_RegionRef ref)
         {
-            check(OTF2_EvtWriter_Leave(evt_wrt_, nullptr, convert(timestamp), ref),
+            if (profile_)
+            {
+                profile_->leave(timestamp, ref);
+                return;
+            }
+
+            check(OTF2_EvtWriter_Leave(evt_writer(), nullptr, convert(timestamp), ref),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written_at<otf2::event::leave>(timestamp);
+        }
+
+        /**
+         * \brief writes a run of enter events
+         *
+         * The i-th event enters regions[i] at timestamps[i]. The number of events of the location
+         * is updated once for the whole run.
+         */
+        void write_enters(const otf2::chrono::time_point* timestamps, const OTF2_RegionRef* regions,
+                          std::size_t count)
+        {
+            if (profile_)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    profile_->enter(timestamps[i], regions[i]);
+                }
+                return;
+            }
+
+            write_batch<otf2::event::enter>(
+                count, [timestamps](std::size_t i) { return timestamps[i]; },
+                [this, timestamps, regions](std::size_t i)
+                {
+                    check(OTF2_EvtWriter_Enter(evt_wrt_, nullptr, convert(timestamps[i]),
+                                               regions[i]),
+                          "Couldn't write event to local event writer.");
+                });
+        }
+
+        /**
+         * \brief writes a run of leave events
+         *
+         * The i-th event leaves regions[i] at timestamps[i]. The number of events of the location
+         * is updated once for the whole run.
+         */
+        void write_leaves(const otf2::chrono::time_point* timestamps, const OTF2_RegionRef* regions,
+                          std::size_t count)
+        {
+            if (profile_)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    profile_->leave(timestamps[i], regions[i]);
+                }
+                return;
+            }
+
+            write_batch<otf2::event::leave>(
+                count, [timestamps](std::size_t i) { return timestamps[i]; },
+                [this, timestamps, regions](std::size_t i)
+                {
+                    check(OTF2_EvtWriter_Leave(evt_wrt_, nullptr, convert(timestamps[i]),
+                                               regions[i]),
+                          "Couldn't write event to local event writer.");
+                });
+        }
+
+        /**
+         * \brief writes count events from the given array
+         *
+         * The number of events of the location is updated once for the whole array.
+         */
+        template <typename Event>
+        void write(const Event* events, std::size_t count)
+        {
+            // the profile swallows some of the events, so they have to be counted one by one
+            if (profile_)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    write(events[i]);
+                }
+                return;
+            }
+
+            in_batch_ = true;
+
+            try
+            {
+                write_batch<Event>(
+                    count, [events](std::size_t i) { return events[i].timestamp(); },
+                    [this, events](std::size_t i) { write(events[i]); });
+            }
+            catch (...)
+            {
+                in_batch_ = false;
+                throw;
+            }
+
+            in_batch_ = false;
         }
 
     public:
         void write(const otf2::event::thread_acquire_lock& data)
         {
             check(OTF2_EvtWriter_ThreadAcquireLock(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       static_cast<OTF2_Paradigm>(data.paradigm()), data.lock_id(), data.order()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_fork& data)
         {
             check(OTF2_EvtWriter_ThreadFork(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       static_cast<OTF2_Paradigm>(data.paradigm()), data.num_threads()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_join& data)
         {
-            check(OTF2_EvtWriter_ThreadJoin(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_ThreadJoin(evt_writer(), data.attribute_list().get(),
                                             convert(data.timestamp()),
                                             static_cast<OTF2_Paradigm>(data.paradigm())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_release_lock& data)
         {
             check(OTF2_EvtWriter_ThreadReleaseLock(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       static_cast<OTF2_Paradigm>(data.paradigm()), data.lock_id(), data.order()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_task_complete& data)
@@ -506,13 +751,14 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_ThreadTaskComplete(evt_wrt_, data.attribute_list().get(),
-                                                            convert(data.timestamp()), comm.ref(),
-                                                            data.thread(), data.generation()),
+                    check(OTF2_EvtWriter_ThreadTaskComplete(
+                              evt_writer(), data.attribute_list().get(),
+                              convert(data.timestamp()), comm.ref(), data.thread(),
+                              data.generation()),
                           "Couldn't write event to local event writer.");
                 },
                 data.team_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_task_create& data)
@@ -520,13 +766,13 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_ThreadTaskCreate(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_ThreadTaskCreate(evt_writer(), data.attribute_list().get(),
                                                           convert(data.timestamp()), comm.ref(),
                                                           data.thread(), data.generation()),
                           "Couldn't write event to local event writer.");
                 },
                 data.team_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_task_switch& data)
@@ -534,13 +780,13 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_ThreadTaskSwitch(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_ThreadTaskSwitch(evt_writer(), data.attribute_list().get(),
                                                           convert(data.timestamp()), comm.ref(),
                                                           data.thread(), data.generation()),
                           "Couldn't write event to local event writer.");
                 },
                 data.team_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_team_begin& data)
@@ -548,12 +794,12 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_ThreadTeamBegin(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_ThreadTeamBegin(evt_writer(), data.attribute_list().get(),
                                                          convert(data.timestamp()), comm.ref()),
                           "Couldn't write event to local event writer.");
                 },
                 data.comm_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_team_end& data)
@@ -561,12 +807,12 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_ThreadTeamEnd(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_ThreadTeamEnd(evt_writer(), data.attribute_list().get(),
                                                        convert(data.timestamp()), comm.ref()),
                           "Couldn't write event to local event writer.");
                 },
                 data.comm_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_create& data)
@@ -574,13 +820,13 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_ThreadCreate(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_ThreadCreate(evt_writer(), data.attribute_list().get(),
                                                       convert(data.timestamp()), comm.ref(),
                                                       data.sequence_number()),
                           "Couldn't write event to local event writer.");
                 },
                 data.thread_contingent_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_begin& data)
@@ -588,13 +834,13 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_ThreadBegin(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_ThreadBegin(evt_writer(), data.attribute_list().get(),
                                                      convert(data.timestamp()), comm.ref(),
                                                      data.sequence_number()),
                           "Couldn't write event to local event writer.");
                 },
                 data.thread_contingent_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_wait& data)
@@ -602,13 +848,13 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_ThreadWait(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_ThreadWait(evt_writer(), data.attribute_list().get(),
                                                     convert(data.timestamp()), comm.ref(),
                                                     data.sequence_number()),
                           "Couldn't write event to local event writer.");
                 },
                 data.thread_contingent_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::thread_end& data)
@@ -616,309 +862,309 @@ namespace writer
             std::visit(
                 [&](auto&& comm)
                 {
-                    check(OTF2_EvtWriter_ThreadEnd(evt_wrt_, data.attribute_list().get(),
+                    check(OTF2_EvtWriter_ThreadEnd(evt_writer(), data.attribute_list().get(),
                                                    convert(data.timestamp()), comm.ref(),
                                                    data.sequence_number()),
                           "Couldn't write event to local event writer.");
                 },
                 data.thread_contingent_);
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_acquire_lock& data)
         {
-            check(OTF2_EvtWriter_RmaAcquireLock(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaAcquireLock(evt_writer(), data.attribute_list().get(),
                                                 convert(data.timestamp()), data.win().ref(),
                                                 data.remote(), data.lock(),
                                                 static_cast<OTF2_LockType>(data.lock_type())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_atomic& data)
         {
             check(OTF2_EvtWriter_RmaAtomic(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       data.win().ref(), data.remote(), static_cast<OTF2_RmaAtomicType>(data.type()),
                       data.sent(), data.received(), data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_collective_begin& data)
         {
-            check(OTF2_EvtWriter_RmaCollectiveBegin(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaCollectiveBegin(evt_writer(), data.attribute_list().get(),
                                                     convert(data.timestamp())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_collective_end& data)
         {
             check(OTF2_EvtWriter_RmaCollectiveEnd(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       static_cast<OTF2_CollectiveOp>(data.type()),
                       static_cast<OTF2_RmaSyncLevel>(data.level()), data.win().ref(), data.root(),
                       data.sent(), data.received()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_get& data)
         {
-            check(OTF2_EvtWriter_RmaGet(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaGet(evt_writer(), data.attribute_list().get(),
                                         convert(data.timestamp()), data.win().ref(), data.remote(),
                                         data.bytes(), data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_group_sync& data)
         {
-            check(OTF2_EvtWriter_RmaGroupSync(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaGroupSync(evt_writer(), data.attribute_list().get(),
                                               convert(data.timestamp()),
                                               static_cast<OTF2_RmaSyncLevel>(data.level()),
                                               data.win().ref(), data.group().ref()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_op_complete_blocking& data)
         {
-            check(OTF2_EvtWriter_RmaOpCompleteBlocking(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaOpCompleteBlocking(evt_writer(), data.attribute_list().get(),
                                                        convert(data.timestamp()), data.win().ref(),
                                                        data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_op_complete_non_blocking& data)
         {
-            check(OTF2_EvtWriter_RmaOpCompleteNonBlocking(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaOpCompleteNonBlocking(evt_writer(), data.attribute_list().get(),
                                                           convert(data.timestamp()),
                                                           data.win().ref(), data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_op_test& data)
         {
-            check(OTF2_EvtWriter_RmaOpTest(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaOpTest(evt_writer(), data.attribute_list().get(),
                                            convert(data.timestamp()), data.win().ref(),
                                            data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_op_complete_remote& data)
         {
-            check(OTF2_EvtWriter_RmaOpCompleteRemote(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaOpCompleteRemote(evt_writer(), data.attribute_list().get(),
                                                      convert(data.timestamp()), data.win().ref(),
                                                      data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_put& data)
         {
-            check(OTF2_EvtWriter_RmaPut(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaPut(evt_writer(), data.attribute_list().get(),
                                         convert(data.timestamp()), data.win().ref(), data.remote(),
                                         data.bytes(), data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_release_lock& data)
         {
-            check(OTF2_EvtWriter_RmaReleaseLock(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaReleaseLock(evt_writer(), data.attribute_list().get(),
                                                 convert(data.timestamp()), data.win().ref(),
                                                 data.remote(), data.lock()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_request_lock& data)
         {
-            check(OTF2_EvtWriter_RmaRequestLock(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaRequestLock(evt_writer(), data.attribute_list().get(),
                                                 convert(data.timestamp()), data.win().ref(),
                                                 data.remote(), data.lock(),
                                                 static_cast<OTF2_LockType>(data.lock_type())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_sync& data)
         {
-            check(OTF2_EvtWriter_RmaSync(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaSync(evt_writer(), data.attribute_list().get(),
                                          convert(data.timestamp()), data.win().ref(), data.remote(),
                                          static_cast<OTF2_RmaSyncType>(data.sync_type())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_try_lock& data)
         {
-            check(OTF2_EvtWriter_RmaTryLock(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaTryLock(evt_writer(), data.attribute_list().get(),
                                             convert(data.timestamp()), data.win().ref(),
                                             data.remote(), data.lock(),
                                             static_cast<OTF2_LockType>(data.lock_type())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_wait_change& data)
         {
-            check(OTF2_EvtWriter_RmaWaitChange(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaWaitChange(evt_writer(), data.attribute_list().get(),
                                                convert(data.timestamp()), data.win().ref()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_win_create& data)
         {
-            check(OTF2_EvtWriter_RmaWinCreate(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaWinCreate(evt_writer(), data.attribute_list().get(),
                                               convert(data.timestamp()), data.win().ref()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::rma_win_destroy& data)
         {
-            check(OTF2_EvtWriter_RmaWinDestroy(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_RmaWinDestroy(evt_writer(), data.attribute_list().get(),
                                                convert(data.timestamp()), data.win().ref()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_create_handle& data)
         {
             check(OTF2_EvtWriter_IoCreateHandle(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       data.handle().ref(), static_cast<OTF2_IoAccessMode>(data.access_mode()),
                       static_cast<OTF2_IoCreationFlag>(data.creation_flags()),
                       static_cast<OTF2_IoStatusFlag>(data.status_flags())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_destroy_handle& data)
         {
-            check(OTF2_EvtWriter_IoDestroyHandle(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_IoDestroyHandle(evt_writer(), data.attribute_list().get(),
                                                  convert(data.timestamp()), data.handle().ref()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_duplicate_handle& data)
         {
             check(OTF2_EvtWriter_IoDuplicateHandle(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       data.old_handle().ref(), data.new_handle().ref(),
                       static_cast<OTF2_IoStatusFlag>(data.status_flags())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_seek& data)
         {
             check(OTF2_EvtWriter_IoSeek(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       data.handle().ref(), data.offset_request(),
                       static_cast<OTF2_IoSeekOption>(data.seek_option()), data.offset_result()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_change_status_flag& data)
         {
             check(OTF2_EvtWriter_IoChangeStatusFlags(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       data.handle().ref(), static_cast<OTF2_IoStatusFlag>(data.status_flags())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_delete_file& data)
         {
-            check(OTF2_EvtWriter_IoDeleteFile(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_IoDeleteFile(evt_writer(), data.attribute_list().get(),
                                               convert(data.timestamp()), data.paradigm().ref(),
                                               data.file().ref()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_operation_begin& data)
         {
             check(OTF2_EvtWriter_IoOperationBegin(
-                      evt_wrt_, data.attribute_list().get(), convert(data.timestamp()),
+                      evt_writer(), data.attribute_list().get(), convert(data.timestamp()),
                       data.handle().ref(), static_cast<OTF2_IoOperationMode>(data.operation_mode()),
                       static_cast<OTF2_IoOperationFlag>(data.operation_flag()),
                       data.bytes_request(), data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_operation_test& data)
         {
-            check(OTF2_EvtWriter_IoOperationTest(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_IoOperationTest(evt_writer(), data.attribute_list().get(),
                                                  convert(data.timestamp()), data.handle().ref(),
                                                  data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_operation_issued& data)
         {
-            check(OTF2_EvtWriter_IoOperationIssued(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_IoOperationIssued(evt_writer(), data.attribute_list().get(),
                                                    convert(data.timestamp()), data.handle().ref(),
                                                    data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_operation_complete& data)
         {
-            check(OTF2_EvtWriter_IoOperationComplete(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_IoOperationComplete(evt_writer(), data.attribute_list().get(),
                                                      convert(data.timestamp()), data.handle().ref(),
                                                      data.bytes_request(), data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_operation_cancelled& data)
         {
-            check(OTF2_EvtWriter_IoOperationCancelled(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_IoOperationCancelled(evt_writer(), data.attribute_list().get(),
                                                       convert(data.timestamp()),
                                                       data.handle().ref(), data.matching_id()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_acquire_lock& data)
         {
-            check(OTF2_EvtWriter_IoAcquireLock(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_IoAcquireLock(evt_writer(), data.attribute_list().get(),
                                                convert(data.timestamp()), data.handle().ref(),
                                                static_cast<OTF2_LockType>(data.lock_type())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_release_lock& data)
         {
-            check(OTF2_EvtWriter_IoReleaseLock(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_IoReleaseLock(evt_writer(), data.attribute_list().get(),
                                                convert(data.timestamp()), data.handle().ref(),
                                                static_cast<OTF2_LockType>(data.lock_type())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::io_try_lock& data)
         {
-            check(OTF2_EvtWriter_IoTryLock(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_IoTryLock(evt_writer(), data.attribute_list().get(),
                                            convert(data.timestamp()), data.handle().ref(),
                                            static_cast<OTF2_LockType>(data.lock_type())),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::program_begin& data)
@@ -932,21 +1178,27 @@ namespace writer
                 args.push_back(arg.ref());
             }
 
-            check(OTF2_EvtWriter_ProgramBegin(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_ProgramBegin(evt_writer(), data.attribute_list().get(),
                                               convert(data.timestamp()), data.name().ref(),
                                               numberOfArguments, args.data()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
         void write(const otf2::event::program_end& data)
         {
-            check(OTF2_EvtWriter_ProgramEnd(evt_wrt_, data.attribute_list().get(),
+            check(OTF2_EvtWriter_ProgramEnd(evt_writer(), data.attribute_list().get(),
                                             convert(data.timestamp()), data.exit_status()),
                   "Couldn't write event to local event writer.");
-            location_.event_written();
+            written(data);
         }
 
+    public:
+        /**
+         * \brief returns a writer for events given as plain reference numbers and ticks
+         */
+        inline raw_local raw();
+
     public:
         void write(const otf2::definition::mapping_table& def)
         {
@@ -956,21 +1208,301 @@ namespace writer
         }
 
     private:
-        static OTF2_TimeStamp convert(otf2::chrono::time_point tp)
+        // timestamp(i) returns the timestamp of the i-th event, write(i) writes it
+        template <typename Event, typename Timestamp, typename Write>
+        void write_batch(std::size_t count, Timestamp&& timestamp, Write&& write)
+        {
+            std::size_t i = 0;
+
+            if (statistics_)
+            {
+                statistics_->begin_write();
+            }
+
+            try
+            {
+                for (; i < count; ++i)
+                {
+                    write(i);
+                }
+            }
+            catch (...)
+            {
+                batch_written<Event>(timestamp, i);
+                throw;
+            }
+
+            batch_written<Event>(timestamp, count);
+        }
+
+        template <typename Event, typename Timestamp>
+        void batch_written(Timestamp&& timestamp, std::size_t count)
+        {
+            location_.events_written(count);
+
+            if (statistics_)
+            {
+                if (count > 0)
+                {
+                    statistics_->end_write<Event>(convert(timestamp(count - 1)), count);
+                }
+                else
+                {
+                    statistics_->end_write();
+                }
+            }
+        }
+
+        /**
+         * \brief returns the event writer for an OTF2 call, which is timed for the statistics
+         */
+        OTF2_EvtWriter* evt_writer()
+        {
+            // a batch is timed as a whole
+            if (statistics_ && !in_batch_)
+            {
+                statistics_->begin_write();
+            }
+
+            return evt_wrt_;
+        }
+
+        template <typename Event>
+        void written(const Event& event)
+        {
+            // a batch is counted as a whole
+            if (in_batch_)
+            {
+                return;
+            }
+
+            location_.event_written();
+
+            if (statistics_)
+            {
+                statistics_->end_write<Event>(convert(event.timestamp()));
+            }
+        }
+
+        template <typename Event>
+        void written_at(otf2::chrono::time_point timestamp)
+        {
+            if (in_batch_)
+            {
+                return;
+            }
+
+            location_.event_written();
+
+            if (statistics_)
+            {
+                statistics_->end_write<Event>(convert(timestamp));
+            }
+        }
+
+        template <typename Event>
+        void written_at(OTF2_TimeStamp timestamp)
+        {
+            if (in_batch_)
+            {
+                return;
+            }
+
+            location_.event_written();
+
+            if (statistics_)
+            {
+                statistics_->end_write<Event>(timestamp);
+            }
+        }
+
+        void write_statistics()
+        {
+            if (!statistics_metrics_.is_valid() || statistics_->events() == 0)
+            {
+                return;
+            }
+
+            // the metric event itself isn't counted
+            const auto& stats = *statistics_;
+
+            std::array<OTF2_Type, 4> types = { OTF2_TYPE_UINT64, OTF2_TYPE_UINT64,
+                                               OTF2_TYPE_DOUBLE, OTF2_TYPE_DOUBLE };
+            std::array<OTF2_MetricValue, 4> values;
+            values[0].unsigned_int = stats.events();
+            values[1].unsigned_int = stats.flushes();
+            values[2].floating_point =
+                std::chrono::duration<double>(stats.flush_time()).count();
+            values[3].floating_point =
+                std::chrono::duration<double>(stats.write_time()).count();
+
+            check(OTF2_EvtWriter_Metric(evt_wrt_, nullptr, stats.last_timestamp(),
+                                        statistics_metrics_.ref(), types.size(), types.data(),
+                                        values.data()),
+                  "Couldn't write event to local event writer.");
+            location_.event_written();
+        }
+
+        void close_evt_writer()
+        {
+            if (statistics_)
+            {
+                statistics_->begin_write();
+            }
+
+            // the final flush of the event buffer happens here
+            check(OTF2_Archive_CloseEvtWriter(ar_, evt_wrt_), "Couldn't close event writer");
+
+            if (statistics_)
+            {
+                statistics_->end_write();
+            }
+        }
+
+        void write_profile()
+        {
+            // take the profile first, so its events are written instead of profiled again
+            auto profile = std::move(profile_);
+            profile->write(*this);
+        }
+
+    private:
+        OTF2_TimeStamp convert(otf2::chrono::time_point tp) const
         {
-            static otf2::chrono::convert cvrt;
             static_assert(otf2::chrono::clock::period::num == 1,
                           "Don't mess around with the chrono stuff!");
-            return cvrt(tp).count();
+            return (*convert_)(tp).count();
+        }
+
+        static const otf2::chrono::convert& default_convert()
+        {
+            static const otf2::chrono::convert cvrt;
+            return cvrt;
         }
 
     private:
+        friend class raw_local;
+
         otf2::definition::location location_;
         OTF2_Archive* ar_;
         OTF2_DefWriter* def_wrt_;
         OTF2_EvtWriter* evt_wrt_;
+        const otf2::chrono::convert* convert_;
+        std::unique_ptr<otf2::writer::profile> profile_;
+        std::unique_ptr<otf2::writer::statistics> statistics_;
+        otf2::definition::metric_class statistics_metrics_;
+
+        // set while write() of an array counts and times all of its events at once
+        bool in_batch_ = false;
     };
 
+    /**
+     * \brief writes events given as plain reference numbers and timestamps in ticks
+     *
+     * This is meant for instrumentation hooks, which already know the reference numbers of their
+     * definitions. No event objects are constructed and the timestamps aren't converted, i.e.
+     * they have to be given in the resolution of the clock properties of the trace.
+     *
+     * The object is only a view on the local writer, obtained by local::raw().
+     */
+    class raw_local
+    {
+    public:
+        explicit raw_local(local& writer) : writer_(&writer)
+        {
+        }
+
+        void enter(OTF2_TimeStamp timestamp, OTF2_RegionRef region)
+        {
+            check(OTF2_EvtWriter_Enter(writer_->evt_writer(), nullptr, timestamp, region),
+                  "Couldn't write event to local event writer.");
+            writer_->written_at<otf2::event::enter>(timestamp);
+        }
+
+        void leave(OTF2_TimeStamp timestamp, OTF2_RegionRef region)
+        {
+            check(OTF2_EvtWriter_Leave(writer_->evt_writer(), nullptr, timestamp, region),
+                  "Couldn't write event to local event writer.");
+            writer_->written_at<otf2::event::leave>(timestamp);
+        }
+
+        void calling_context_enter(OTF2_TimeStamp timestamp, OTF2_CallingContextRef calling_context,
+                                   std::uint32_t unwind_distance)
+        {
+            check(OTF2_EvtWriter_CallingContextEnter(writer_->evt_writer(), nullptr, timestamp,
+                                                     calling_context, unwind_distance),
+                  "Couldn't write event to local event writer.");
+            writer_->written_at<otf2::event::calling_context_enter>(timestamp);
+        }
+
+        void calling_context_leave(OTF2_TimeStamp timestamp, OTF2_CallingContextRef calling_context)
+        {
+            check(OTF2_EvtWriter_CallingContextLeave(writer_->evt_writer(), nullptr, timestamp,
+                                                     calling_context),
+                  "Couldn't write event to local event writer.");
+            writer_->written_at<otf2::event::calling_context_leave>(timestamp);
+        }
+
+        void calling_context_sample(OTF2_TimeStamp timestamp,
+                                    OTF2_CallingContextRef calling_context,
+                                    std::uint32_t unwind_distance,
+                                    OTF2_InterruptGeneratorRef interrupt_generator)
+        {
+            check(OTF2_EvtWriter_CallingContextSample(writer_->evt_writer(), nullptr, timestamp,
+                                                      calling_context, unwind_distance,
+                                                      interrupt_generator),
+                  "Couldn't write event to local event writer.");
+            writer_->written_at<otf2::event::calling_context_sample>(timestamp);
+        }
+
+        void parameter_int(OTF2_TimeStamp timestamp, OTF2_ParameterRef parameter,
+                           std::int64_t value)
+        {
+            check(OTF2_EvtWriter_ParameterInt(writer_->evt_writer(), nullptr, timestamp, parameter,
+                                              value),
+                  "Couldn't write event to local event writer.");
+            writer_->written_at<otf2::event::parameter_int>(timestamp);
+        }
+
+        void parameter_unsigned_int(OTF2_TimeStamp timestamp, OTF2_ParameterRef parameter,
+                                    std::uint64_t value)
+        {
+            check(OTF2_EvtWriter_ParameterUnsignedInt(writer_->evt_writer(), nullptr, timestamp,
+                                                      parameter, value),
+                  "Couldn't write event to local event writer.");
+            writer_->written_at<otf2::event::parameter_unsigned_int>(timestamp);
+        }
+
+        void parameter_string(OTF2_TimeStamp timestamp, OTF2_ParameterRef parameter,
+                              OTF2_StringRef value)
+        {
+            check(OTF2_EvtWriter_ParameterString(writer_->evt_writer(), nullptr, timestamp,
+                                                 parameter, value),
+                  "Couldn't write event to local event writer.");
+            writer_->written_at<otf2::event::parameter_string>(timestamp);
+        }
+
+        /**
+         * \brief writes a metric event with count values of the given metric class or instance
+         */
+        void metric(OTF2_TimeStamp timestamp, OTF2_MetricRef metric, std::uint8_t count,
+                    const OTF2_Type* types, const OTF2_MetricValue* values)
+        {
+            check(OTF2_EvtWriter_Metric(writer_->evt_writer(), nullptr, timestamp, metric, count,
+                                        types, values),
+                  "Couldn't write event to local event writer.");
+            writer_->written_at<otf2::event::metric>(timestamp);
+        }
+
+    private:
+        local* writer_;
+    };
+
+    inline raw_local local::raw()
+    {
+        return raw_local(*this);
+    }
+
     template <typename Record>
     local& operator<<(local& wrt, Record rec)
     {
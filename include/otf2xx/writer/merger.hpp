@@ -0,0 +1,965 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_MERGER_HPP
+#define INCLUDE_OTF2XX_WRITER_MERGER_HPP
+
+#include <otf2xx/common.hpp>
+#include <otf2xx/exception.hpp>
+#include <otf2xx/reader/forwarding_callback.hpp>
+#include <otf2xx/reader/reader.hpp>
+#include <otf2xx/registry.hpp>
+#include <otf2xx/writer/archive.hpp>
+#include <otf2xx/writer/local.hpp>
+
+#include <otf2xx/chrono/chrono.hpp>
+#include <otf2xx/chrono/clock_correction.hpp>
+#include <otf2xx/definition/definitions.hpp>
+#include <otf2xx/event/events.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace otf2
+{
+namespace writer
+{
+
+    namespace detail
+    {
+        /**
+         * \brief the state of one input trace of a merge
+         */
+        struct merge_input
+        {
+            std::string path;
+            otf2::definition::clock_properties clock;
+
+            // the shift of the input on the common timeline in ticks of its clock
+            std::int64_t clock_offset = 0;
+
+            // the references of the output by the references of the input
+            std::map<otf2::common::mapping_type_type, std::vector<std::uint32_t>> mappings;
+
+            // the output locations and their writers by the references of the input
+            std::map<OTF2_LocationRef, otf2::definition::location> locations;
+            std::unordered_map<OTF2_LocationRef, otf2::writer::local*> writers;
+        };
+
+        /**
+         * \brief writes the events of a reader to the local writers of their locations
+         */
+        class event_writer : public otf2::reader::forwarding_callback<event_writer>
+        {
+        public:
+            explicit event_writer(
+                const std::unordered_map<OTF2_LocationRef, otf2::writer::local*>& writers)
+            : writers_(writers)
+            {
+            }
+
+        private:
+            template <typename, typename>
+            friend class otf2::reader::detail::forwarding_callback_impl;
+
+            template <typename Event>
+            void forward(const otf2::definition::location& location, const Event& event)
+            {
+                auto it = writers_.find(location.ref().get());
+
+                if (it != writers_.end())
+                {
+                    it->second->write(event);
+                }
+            }
+
+        private:
+            std::unordered_map<OTF2_LocationRef, otf2::writer::local*> writers_;
+        };
+    } // namespace detail
+
+    /**
+     * \brief merges several traces into one archive
+     *
+     * The definitions of all inputs are unified by their content, e.g. two regions with the same
+     * name, file and line numbers become one region of the output. Locations are never unified,
+     * as each of them owns an event stream. The comm locations groups of a paradigm are
+     * concatenated, while all other groups, comms and metric instances stay separate per input.
+     *
+     * Events are copied unchanged. Instead, every location of the output gets mapping tables from
+     * the references of its input to the unified references, which are applied when reading the
+     * output. The event streams of the locations are copied in parallel threads, each reading its
+     * share of the locations with an own reader.
+     *
+     * If clocks are aligned, the inputs are placed on one timeline by the realtime timestamps of
+     * their clock properties, if all inputs have one, or by their start times otherwise. Without
+     * alignment, all inputs start at the same time. The output uses the finest resolution of all
+     * inputs.
+     *
+     * Inputs with definitions, which can't be unified yet, e.g. RMA windows or IO files, are
+     * rejected with an exception.
+     */
+    template <typename Registry>
+    class Merger
+    {
+        using key_type = std::vector<std::uint64_t>;
+
+        template <typename Definition>
+        using unified_map = std::map<key_type, Definition>;
+
+        template <typename Definition>
+        using input_map = std::unordered_map<std::uint64_t, Definition>;
+
+        // the key part for definitions without parent
+        static constexpr std::uint64_t no_parent = ~std::uint64_t(0);
+
+    public:
+        /**
+         * \param output the archive to write to, which has to be the master
+         * \param align_clocks whether to align the inputs by their clock properties
+         */
+        explicit Merger(Archive<Registry>& output, bool align_clocks = true)
+        : output_(output), align_clocks_(align_clocks)
+        {
+        }
+
+    public:
+        /**
+         * \brief adds the trace with the given anchor file to the inputs
+         */
+        void add(const std::string& input)
+        {
+            inputs_.emplace_back();
+            inputs_.back().path = input;
+        }
+
+        /**
+         * \brief merges all inputs into the archive
+         *
+         * \param threads the number of threads copying event streams, only 1 with non-atomic
+         *        reference counts
+         */
+        void run(std::size_t threads = 1)
+        {
+#ifdef OTF2XX_NON_ATOMIC_REFCOUNT
+            if (threads > 1)
+            {
+                make_exception("Several threads need atomic reference counts, see "
+                               "OTF2XX_ATOMIC_REFCOUNT");
+            }
+#endif
+
+            if (inputs_.empty())
+            {
+                make_exception("There are no traces to merge");
+            }
+
+            for (auto& input : inputs_)
+            {
+                detail::event_writer definitions_only({});
+
+                otf2::reader::reader rdr(input.path);
+                rdr.set_callback(definitions_only);
+                rdr.read_definitions();
+
+                merge_definitions(rdr, input);
+            }
+
+            merge_clocks();
+
+            // create all local writers upfront and give them their mapping tables
+            std::vector<std::pair<std::size_t, OTF2_LocationRef>> tasks;
+            for (std::size_t i = 0; i < inputs_.size(); ++i)
+            {
+                for (const auto& location : inputs_[i].locations)
+                {
+                    auto& writer = output_(location.second);
+                    write_mappings(inputs_[i], writer);
+
+                    inputs_[i].writers.emplace(location.first, &writer);
+                    tasks.emplace_back(i, location.first);
+                }
+            }
+
+            threads = std::max<std::size_t>(1, std::min(threads, tasks.size()));
+
+            std::vector<std::thread> workers;
+            std::exception_ptr error;
+            std::mutex error_mutex;
+
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+                workers.emplace_back(
+                    [this, t, threads, &tasks, &error, &error_mutex]()
+                    {
+                        try
+                        {
+                            copy_events(tasks, t, threads);
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lock(error_mutex);
+                            if (!error)
+                            {
+                                error = std::current_exception();
+                            }
+                        }
+                    });
+            }
+
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+    private:
+        void copy_events(const std::vector<std::pair<std::size_t, OTF2_LocationRef>>& tasks,
+                         std::size_t first, std::size_t stride)
+        {
+            for (std::size_t i = 0; i < inputs_.size(); ++i)
+            {
+                const auto& input = inputs_[i];
+
+                std::vector<OTF2_LocationRef> locations;
+                for (auto task = first; task < tasks.size(); task += stride)
+                {
+                    if (tasks[task].first == i)
+                    {
+                        locations.push_back(tasks[task].second);
+                    }
+                }
+
+                if (locations.empty())
+                {
+                    continue;
+                }
+
+                detail::event_writer sink(input.writers);
+
+                otf2::reader::reader rdr(input.path);
+                rdr.set_callback(sink);
+                rdr.read_definitions();
+
+                for (auto ref : locations)
+                {
+                    const auto& location = rdr.registry().template get<otf2::definition::location>(
+                        otf2::definition::location::reference_type(ref));
+
+                    if (input.clock_offset != 0)
+                    {
+                        rdr.set_clock_correction(
+                            location, otf2::chrono::clock_correction::linear(input.clock_offset));
+                    }
+
+                    rdr.register_location(location);
+                }
+
+                rdr.read_events();
+            }
+        }
+
+        void merge_clocks()
+        {
+            bool realtime = true;
+            for (const auto& input : inputs_)
+            {
+                realtime = realtime &&
+                           input.clock.realtime_timestamp().count() != OTF2_UNDEFINED_TIMESTAMP;
+            }
+
+            // the begin and end of each input in seconds on the common timeline
+            auto begin = [realtime](const detail::merge_input& input) -> long double
+            {
+                const auto& clock = input.clock;
+
+                if (realtime)
+                {
+                    return clock.realtime_timestamp().count() * 1e-9L;
+                }
+
+                return static_cast<long double>(clock.start_time().count()) /
+                       clock.ticks_per_second().count();
+            };
+
+            auto length = [](const detail::merge_input& input) -> long double
+            {
+                return static_cast<long double>(input.clock.length().count()) /
+                       input.clock.ticks_per_second().count();
+            };
+
+            // the earliest input defines the start of the output
+            const detail::merge_input* earliest = &inputs_.front();
+            std::uint64_t ticks_per_second = 0;
+
+            for (const auto& input : inputs_)
+            {
+                if (align_clocks_ && begin(input) < begin(*earliest))
+                {
+                    earliest = &input;
+                }
+
+                ticks_per_second = std::max(ticks_per_second,
+                                            input.clock.ticks_per_second().count());
+            }
+
+            long double end = 0;
+
+            for (auto& input : inputs_)
+            {
+                long double shift = align_clocks_ ? begin(input) - begin(*earliest) : 0;
+
+                input.clock_offset = static_cast<std::int64_t>(
+                    std::llround(shift * input.clock.ticks_per_second().count()));
+
+                end = std::max(end, shift + length(input));
+            }
+
+            auto start_time = static_cast<std::uint64_t>(
+                std::llround(static_cast<long double>(earliest->clock.start_time().count()) *
+                             ticks_per_second / earliest->clock.ticks_per_second().count()));
+
+            otf2::definition::clock_properties clock(
+                otf2::chrono::ticks(ticks_per_second), otf2::chrono::ticks(start_time),
+                otf2::chrono::ticks(static_cast<std::uint64_t>(
+                    std::llround(end * ticks_per_second))),
+                realtime ? earliest->clock.realtime_timestamp()
+                         : otf2::chrono::ticks(OTF2_UNDEFINED_TIMESTAMP));
+
+            output_ << clock;
+            output_.set_clock_convert(otf2::chrono::convert(clock));
+        }
+
+        void write_mappings(const detail::merge_input& input, otf2::writer::local& writer) const
+        {
+            for (const auto& mapping : input.mappings)
+            {
+                bool identity = true;
+                for (std::size_t i = 0; i < mapping.second.size() && identity; ++i)
+                {
+                    identity = mapping.second[i] == i ||
+                               mapping.second[i] == OTF2_UNDEFINED_UINT32;
+                }
+
+                if (!identity)
+                {
+                    writer.write(otf2::definition::mapping_table(mapping.first, mapping.second));
+                }
+            }
+        }
+
+    private:
+        template <typename Definition>
+        static void check_unsupported(const otf2::registry& reg, const char* name)
+        {
+            const auto& defs = reg.template all<Definition>();
+
+            if (defs.begin() != defs.end())
+            {
+                make_exception("Merging traces with ", name, " definitions isn't supported");
+            }
+        }
+
+        /**
+         * \brief returns the output definition with the given content, creating it if necessary
+         */
+        template <typename Definition, typename... Args>
+        Definition unified(unified_map<Definition>& defs, key_type key, Args&&... args)
+        {
+            auto it = defs.find(key);
+
+            if (it == defs.end())
+            {
+                it = defs.emplace(std::move(key), output_.registry().template create<Definition>(
+                                                      std::forward<Args>(args)...))
+                         .first;
+            }
+
+            return it->second;
+        }
+
+        template <typename Definition>
+        static void map(detail::merge_input& input, otf2::common::mapping_type_type type,
+                        const Definition& from, const Definition& to)
+        {
+            auto& mapping = input.mappings[type];
+            auto ref = static_cast<std::size_t>(from.ref().get());
+
+            if (ref >= mapping.size())
+            {
+                mapping.resize(ref + 1, OTF2_UNDEFINED_UINT32);
+            }
+
+            mapping[ref] = static_cast<std::uint32_t>(to.ref().get());
+        }
+
+        void merge_definitions(const otf2::reader::reader& rdr, detail::merge_input& input)
+        {
+            using mapping_type = otf2::common::mapping_type_type;
+
+            const auto& reg = rdr.registry();
+
+            check_unsupported<otf2::definition::inter_comm>(reg, "inter comm");
+            check_unsupported<otf2::definition::call_path>(reg, "call path");
+            check_unsupported<otf2::definition::call_path_parameter>(reg, "call path parameter");
+            check_unsupported<otf2::definition::rma_win>(reg, "RMA window");
+            check_unsupported<otf2::definition::io_regular_file>(reg, "IO file");
+            check_unsupported<otf2::definition::io_directory>(reg, "IO directory");
+            check_unsupported<otf2::definition::io_handle>(reg, "IO handle");
+            check_unsupported<otf2::definition::io_paradigm>(reg, "IO paradigm");
+            check_unsupported<otf2::definition::cart_topology>(reg, "cartesian topology");
+
+            if (!rdr.has_clock_properties())
+            {
+                make_exception("The trace '", input.path, "' has no clock properties");
+            }
+
+            input.clock = rdr.clock_properties();
+
+            input_map<otf2::definition::string> strings;
+            for (const auto& def : reg.template all<otf2::definition::string>())
+            {
+                auto it = strings_.find(def.str());
+                if (it == strings_.end())
+                {
+                    auto& out =
+                        output_.registry().template create<otf2::definition::string>(def.str());
+                    it = strings_.emplace(def.str(), out).first;
+                }
+
+                const auto& out = it->second;
+                strings.emplace(def.ref().get(), out);
+                map(input, mapping_type::string, def, out);
+            }
+
+            // optional strings, e.g. the description of a region, refer to OTF2_UNDEFINED_STRING
+            // and stay undefined in the output
+            auto string = [&strings](const otf2::definition::string& def)
+            {
+                if (def.ref() == otf2::definition::string::reference_type::undefined())
+                {
+                    return otf2::definition::string();
+                }
+
+                return strings.at(def.ref().get());
+            };
+
+            for (const auto& def : reg.template all<otf2::definition::attribute>())
+            {
+                auto name = string(def.name());
+                auto description = string(def.description());
+
+                auto out = unified(attributes_,
+                                   { name.ref().get(), description.ref().get(),
+                                     static_cast<std::uint64_t>(def.type()) },
+                                   name, description, def.type());
+                map(input, mapping_type::attribute, def, out);
+            }
+
+            for (const auto& def : reg.template all<otf2::definition::parameter>())
+            {
+                auto name = string(def.name());
+
+                auto out = unified(parameters_,
+                                   { name.ref().get(), static_cast<std::uint64_t>(def.type()) },
+                                   name, def.type());
+                map(input, mapping_type::parameter, def, out);
+            }
+
+            for (const auto& def : reg.template all<otf2::definition::interrupt_generator>())
+            {
+                auto name = string(def.name());
+
+                auto out = unified(
+                    interrupt_generators_,
+                    { name.ref().get(), static_cast<std::uint64_t>(def.interrupt_generator_mode()),
+                      static_cast<std::uint64_t>(def.period_base()),
+                      static_cast<std::uint64_t>(def.period_exponent()), def.period() },
+                    name, def.interrupt_generator_mode(), def.period_base(),
+                    def.period_exponent(), def.period());
+                map(input, mapping_type::interrupt_generator, def, out);
+            }
+
+            input_map<otf2::definition::source_code_location> source_code_locations;
+            for (const auto& def : reg.template all<otf2::definition::source_code_location>())
+            {
+                auto file = string(def.file());
+
+                auto out = unified(source_code_locations_, { file.ref().get(), def.line_number() },
+                                   file, def.line_number());
+                source_code_locations.emplace(def.ref().get(), out);
+                map(input, mapping_type::source_code_location, def, out);
+            }
+
+            input_map<otf2::definition::region> regions;
+            for (const auto& def : reg.template all<otf2::definition::region>())
+            {
+                auto name = string(def.name());
+                auto canonical_name = string(def.canonical_name());
+                auto description = string(def.description());
+                auto source_file = string(def.source_file());
+
+                auto out = unified(
+                    regions_,
+                    { name.ref().get(), canonical_name.ref().get(), description.ref().get(),
+                      static_cast<std::uint64_t>(def.role()),
+                      static_cast<std::uint64_t>(def.paradigm()),
+                      static_cast<std::uint64_t>(def.flags()), source_file.ref().get(),
+                      def.begin_line(), def.end_line() },
+                    name, canonical_name, description, def.role(), def.paradigm(), def.flags(),
+                    source_file, def.begin_line(), def.end_line());
+                regions.emplace(def.ref().get(), out);
+                map(input, mapping_type::region, def, out);
+            }
+
+            input_map<otf2::definition::calling_context> calling_contexts;
+            std::function<otf2::definition::calling_context(
+                const otf2::definition::calling_context&)>
+                calling_context = [&](const otf2::definition::calling_context& def)
+            {
+                auto it = calling_contexts.find(def.ref().get());
+                if (it != calling_contexts.end())
+                {
+                    return it->second;
+                }
+
+                const auto& region = regions.at(def.region().ref().get());
+
+                // the source code location is optional and stays undefined then
+                otf2::definition::source_code_location scl;
+                if (def.source_code_location().is_valid())
+                {
+                    scl = source_code_locations.at(def.source_code_location().ref().get());
+                }
+
+                otf2::definition::calling_context out;
+                auto parent = def.parent();
+
+                if (parent.is_valid())
+                {
+                    auto out_parent = calling_context(parent);
+                    out = unified(calling_contexts_,
+                                  { region.ref().get(), scl.ref().get(), out_parent.ref().get() },
+                                  region, scl, out_parent);
+                }
+                else
+                {
+                    out = unified(calling_contexts_,
+                                  { region.ref().get(), scl.ref().get(), no_parent }, region, scl);
+                }
+
+                calling_contexts.emplace(def.ref().get(), out);
+                map(input, mapping_type::calling_context, def, out);
+
+                return out;
+            };
+
+            for (const auto& def : reg.template all<otf2::definition::calling_context>())
+            {
+                calling_context(def);
+            }
+
+            input_map<otf2::definition::system_tree_node> nodes;
+            std::function<otf2::definition::system_tree_node(
+                const otf2::definition::system_tree_node&)>
+                node = [&](const otf2::definition::system_tree_node& def)
+            {
+                auto it = nodes.find(def.ref().get());
+                if (it != nodes.end())
+                {
+                    return it->second;
+                }
+
+                auto name = string(def.name());
+                auto class_name = string(def.class_name());
+
+                otf2::definition::system_tree_node out;
+                auto parent = def.parent();
+
+                if (parent.is_valid())
+                {
+                    auto out_parent = node(parent);
+                    out = unified(system_tree_nodes_,
+                                  { name.ref().get(), class_name.ref().get(),
+                                    out_parent.ref().get() },
+                                  name, class_name, out_parent);
+                }
+                else
+                {
+                    out = unified(system_tree_nodes_,
+                                  { name.ref().get(), class_name.ref().get(), no_parent }, name,
+                                  class_name);
+                }
+
+                nodes.emplace(def.ref().get(), out);
+
+                return out;
+            };
+
+            for (const auto& def : reg.template all<otf2::definition::system_tree_node>())
+            {
+                node(def);
+            }
+
+            for (const auto& def : reg.template all<otf2::definition::system_tree_node_domain>())
+            {
+                auto out = node(def.node());
+                key_type key{ out.ref().get(), static_cast<std::uint64_t>(def.domain()) };
+
+                if (system_tree_node_domains_.insert(key).second)
+                {
+                    output_ << otf2::definition::system_tree_node_domain(out, def.domain());
+                }
+            }
+
+            input_map<otf2::definition::location_group> location_groups;
+            std::function<otf2::definition::location_group(
+                const otf2::definition::location_group&)>
+                location_group = [&](const otf2::definition::location_group& def)
+            {
+                auto it = location_groups.find(def.ref().get());
+                if (it != location_groups.end())
+                {
+                    return it->second;
+                }
+
+                auto name = string(def.name());
+                auto parent = node(def.parent());
+
+                otf2::definition::location_group out;
+                auto creator = def.creating_location_group();
+
+                if (creator.is_valid())
+                {
+                    auto out_creator = location_group(creator);
+                    out = unified(location_groups_,
+                                  { name.ref().get(), static_cast<std::uint64_t>(def.type()),
+                                    parent.ref().get(), out_creator.ref().get() },
+                                  name, def.type(), parent, out_creator);
+                }
+                else
+                {
+                    out = unified(location_groups_,
+                                  { name.ref().get(), static_cast<std::uint64_t>(def.type()),
+                                    parent.ref().get(), no_parent },
+                                  name, def.type(), parent);
+                }
+
+                location_groups.emplace(def.ref().get(), out);
+
+                return out;
+            };
+
+            for (const auto& def : reg.template all<otf2::definition::location_group>())
+            {
+                location_group(def);
+            }
+
+            // locations are never unified, as they own their event streams
+            for (const auto& def : reg.template all<otf2::definition::location>())
+            {
+                auto out = output_.registry().template create<otf2::definition::location>(
+                    string(def.name()), location_group(def.location_group()), def.type());
+
+                input.locations.emplace(def.ref().get(), out);
+            }
+
+            auto location = [&input](const otf2::definition::location& def)
+            { return input.locations.at(def.ref().get()); };
+
+            input_map<otf2::definition::metric_member> members;
+            for (const auto& def : reg.template all<otf2::definition::metric_member>())
+            {
+                auto name = string(def.name());
+                auto description = string(def.description());
+                auto unit = string(def.value_unit());
+
+                auto out = unified(
+                    metric_members_,
+                    { name.ref().get(), description.ref().get(),
+                      static_cast<std::uint64_t>(def.type()),
+                      static_cast<std::uint64_t>(def.mode()),
+                      static_cast<std::uint64_t>(def.value_type()),
+                      static_cast<std::uint64_t>(def.value_base()),
+                      static_cast<std::uint64_t>(def.value_exponent()), unit.ref().get() },
+                    name, description, def.type(), def.mode(), def.value_type(),
+                    def.value_base(), def.value_exponent(), unit);
+                members.emplace(def.ref().get(), out);
+            }
+
+            input_map<otf2::definition::metric_class> metric_classes;
+            for (const auto& def : reg.template all<otf2::definition::metric_class>())
+            {
+                key_type key{ static_cast<std::uint64_t>(def.occurence()),
+                              static_cast<std::uint64_t>(def.recorder_kind()) };
+                for (const auto& member : def)
+                {
+                    key.push_back(members.at(member.ref().get()).ref().get());
+                }
+
+                auto it = metric_classes_.find(key);
+                if (it == metric_classes_.end())
+                {
+                    auto& out = output_.registry().template create<otf2::definition::metric_class>(
+                        def.occurence(), def.recorder_kind());
+
+                    for (const auto& member : def)
+                    {
+                        out.add_member(members.at(member.ref().get()));
+                    }
+
+                    it = metric_classes_.emplace(std::move(key), out).first;
+                }
+
+                metric_classes.emplace(def.ref().get(), it->second);
+                map(input, mapping_type::metric, def, it->second);
+            }
+
+            // groups are copied with their members translated, except for the comm locations
+            // groups, which are concatenated per paradigm
+            input_map<otf2::definition::locations_group> locations_groups;
+            auto copy_group = [&](const auto& def, auto&& translate)
+            {
+                using group_type = std::decay_t<decltype(def)>;
+
+                auto& out = output_.registry().template create<group_type>(
+                    string(def.name()), def.paradigm(), def.group_flag());
+
+                out.reserve(def.size());
+                for (std::size_t i = 0; i < def.size(); ++i)
+                {
+                    out.add_member(translate(def[i]));
+                }
+
+                map(input, mapping_type::group, def, out);
+
+                return out;
+            };
+
+            for (const auto& def : reg.template all<otf2::definition::locations_group>())
+            {
+                locations_groups.emplace(def.ref().get(), copy_group(def, location));
+            }
+
+            for (const auto& def : reg.template all<otf2::definition::regions_group>())
+            {
+                copy_group(def, [&regions](const otf2::definition::region& region)
+                           { return regions.at(region.ref().get()); });
+            }
+
+            for (const auto& def : reg.template all<otf2::definition::comm_locations_group>())
+            {
+                auto it = comm_locations_groups_.find(def.paradigm());
+                if (it == comm_locations_groups_.end())
+                {
+                    auto& out =
+                        output_.registry().template create<otf2::definition::comm_locations_group>(
+                            string(def.name()), def.paradigm(), def.group_flag());
+
+                    it = comm_locations_groups_.emplace(def.paradigm(), out).first;
+                }
+
+                for (std::size_t i = 0; i < def.size(); ++i)
+                {
+                    it->second.add_member(location(def[i]));
+                }
+
+                map(input, mapping_type::group, def, it->second);
+            }
+
+            input_map<otf2::definition::comm_group> comm_groups;
+            for (const auto& def : reg.template all<otf2::definition::comm_group>())
+            {
+                comm_groups.emplace(def.ref().get(), copy_group(def, location));
+            }
+
+            input_map<otf2::definition::comm_self_group> comm_self_groups;
+            for (const auto& def : reg.template all<otf2::definition::comm_self_group>())
+            {
+                comm_self_groups.emplace(def.ref().get(), copy_group(def, location));
+            }
+
+            input_map<otf2::definition::comm> comms;
+            std::function<otf2::definition::comm(const otf2::definition::comm&)> comm =
+                [&](const otf2::definition::comm& def)
+            {
+                auto it = comms.find(def.ref().get());
+                if (it != comms.end())
+                {
+                    return it->second;
+                }
+
+                auto name = string(def.name());
+
+                otf2::definition::comm::group_type group;
+                if (std::holds_alternative<otf2::definition::comm_group>(def.group()))
+                {
+                    group = comm_groups.at(
+                        std::get<otf2::definition::comm_group>(def.group()).ref().get());
+                }
+                else
+                {
+                    group = comm_self_groups.at(
+                        std::get<otf2::definition::comm_self_group>(def.group()).ref().get());
+                }
+
+                otf2::definition::comm out;
+                auto parent = def.parent();
+
+                if (parent.is_valid())
+                {
+                    out = output_.registry().template create<otf2::definition::comm>(
+                        name, group, comm(parent), def.flags());
+                }
+                else
+                {
+                    out = output_.registry().template create<otf2::definition::comm>(name, group,
+                                                                                     def.flags());
+                }
+
+                comms.emplace(def.ref().get(), out);
+                map(input, mapping_type::comm, def, out);
+
+                return out;
+            };
+
+            for (const auto& def : reg.template all<otf2::definition::comm>())
+            {
+                comm(def);
+            }
+
+            for (const auto& def : reg.template all<otf2::definition::metric_instance>())
+            {
+                const auto& metric_class = metric_classes.at(def.metric_class().ref().get());
+                auto recorder = location(def.recorder());
+
+                otf2::definition::metric_instance out;
+                switch (def.scope())
+                {
+                case otf2::common::metric_scope::location:
+                    out = output_.registry().template create<otf2::definition::metric_instance>(
+                        metric_class, recorder, location(def.location_scope()));
+                    break;
+                case otf2::common::metric_scope::location_group:
+                    out = output_.registry().template create<otf2::definition::metric_instance>(
+                        metric_class, recorder, location_group(def.location_group_scope()));
+                    break;
+                case otf2::common::metric_scope::system_tree_node:
+                    out = output_.registry().template create<otf2::definition::metric_instance>(
+                        metric_class, recorder, node(def.system_tree_node_scope()));
+                    break;
+                case otf2::common::metric_scope::group:
+                    out = output_.registry().template create<otf2::definition::metric_instance>(
+                        metric_class, recorder,
+                        locations_groups.at(def.group_scope().ref().get()));
+                    break;
+                }
+
+                map(input, mapping_type::metric, def, out);
+            }
+
+            for (const auto& def : reg.template all<otf2::definition::location_property>())
+            {
+                output_ << otf2::definition::location_property(location(def.def()),
+                                                               string(def.name()), def.type(),
+                                                               def.value());
+            }
+
+            for (const auto& def : reg.template all<otf2::definition::location_group_property>())
+            {
+                output_ << otf2::definition::location_group_property(
+                    location_group(def.def()), string(def.name()), def.type(), def.value());
+            }
+
+            for (const auto& def :
+                 reg.template all<otf2::definition::system_tree_node_property>())
+            {
+                output_ << otf2::definition::system_tree_node_property(
+                    node(def.def()), string(def.name()), def.type(), def.value());
+            }
+
+            for (const auto& def : reg.template all<otf2::definition::calling_context_property>())
+            {
+                output_ << otf2::definition::calling_context_property(
+                    calling_context(def.def()), string(def.name()), def.type(), def.value());
+            }
+        }
+
+    private:
+        Archive<Registry>& output_;
+        bool align_clocks_;
+
+        std::vector<detail::merge_input> inputs_;
+
+        // the unified definitions of the output by their content
+        std::map<std::string, otf2::definition::string> strings_;
+        unified_map<otf2::definition::attribute> attributes_;
+        unified_map<otf2::definition::parameter> parameters_;
+        unified_map<otf2::definition::interrupt_generator> interrupt_generators_;
+        unified_map<otf2::definition::source_code_location> source_code_locations_;
+        unified_map<otf2::definition::region> regions_;
+        unified_map<otf2::definition::calling_context> calling_contexts_;
+        unified_map<otf2::definition::system_tree_node> system_tree_nodes_;
+        std::set<key_type> system_tree_node_domains_;
+        unified_map<otf2::definition::location_group> location_groups_;
+        unified_map<otf2::definition::metric_member> metric_members_;
+        unified_map<otf2::definition::metric_class> metric_classes_;
+        std::map<otf2::common::paradigm_type, otf2::definition::comm_locations_group>
+            comm_locations_groups_;
+    };
+
+    using merger = Merger<otf2::registry>;
+} // namespace writer
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_WRITER_MERGER_HPP
@@ -0,0 +1,361 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_PROFILE_HPP
+#define INCLUDE_OTF2XX_WRITER_PROFILE_HPP
+
+#include <otf2xx/chrono/chrono.hpp>
+#include <otf2xx/common.hpp>
+#include <otf2xx/definition/metric_class.hpp>
+#include <otf2xx/definition/metric_member.hpp>
+#include <otf2xx/definition/string.hpp>
+#include <otf2xx/event/metric.hpp>
+#include <otf2xx/exception.hpp>
+
+#include <otf2/OTF2_GeneralDefinitions.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace otf2
+{
+namespace writer
+{
+
+    namespace detail
+    {
+        struct profile_node
+        {
+            profile_node(std::uint32_t parent, OTF2_RegionRef region)
+            : parent(parent), region(region)
+            {
+            }
+
+            std::uint32_t parent;
+            OTF2_RegionRef region;
+
+            std::uint64_t visits = 0;
+            otf2::chrono::duration inclusive{ 0 };
+
+            // aggregates of the metric events written within this call path, one per metric
+            std::vector<otf2::event::metric> metrics;
+        };
+    } // namespace detail
+
+    /**
+     * \brief aggregates the enter, leave and metric events of one location to a call-path profile
+     *
+     * Every call path, i.e. region with its chain of callers, is a node of a call tree. The nodes
+     * count their visits and inclusive time, and aggregate the values of the metric events written
+     * within them by the mode of their metric member: relative values are summed up, while
+     * accumulated and absolute values keep the latest one.
+     *
+     * write() emits the profile as a depth-first walk through the call tree. Every call path is
+     * an enter, a metric event of the summary class followed by the aggregates of the other
+     * metrics, the call paths below it, and a leave event. All of them share the latest timestamp
+     * of the profile, so the call tree is preserved but its events take no time.
+     */
+    class profile
+    {
+    public:
+        /**
+         * \param summary metric class with the members visits (uint64), inclusive time and
+         *        exclusive time (both double, in seconds), like the one of make_summary()
+         */
+        explicit profile(const otf2::definition::metric_class& summary) : summary_(summary)
+        {
+            if (summary_.size() != 3)
+            {
+                make_exception("The summary metric class of a profile needs three members");
+            }
+
+            nodes_.emplace_back(0, OTF2_UNDEFINED_REGION);
+            stack_.push_back({ 0, otf2::chrono::genesis() });
+        }
+
+        /**
+         * \brief creates the summary metric class of profiles in the given registry
+         */
+        template <typename Registry>
+        static const otf2::definition::metric_class& make_summary(Registry& reg)
+        {
+            auto& summary = reg.template create<otf2::definition::metric_class>(
+                otf2::common::metric_occurence::async, otf2::common::recorder_kind::abstract);
+
+            auto member = [&reg](const char* name, const char* description,
+                                 otf2::common::type type, const char* unit)
+            {
+                return reg.template create<otf2::definition::metric_member>(
+                    reg.template create<otf2::definition::string>(name),
+                    reg.template create<otf2::definition::string>(description),
+                    otf2::common::metric_type::other, otf2::common::metric_mode::accumulated_start,
+                    type, otf2::common::base_type::decimal, 0,
+                    reg.template create<otf2::definition::string>(unit));
+            };
+
+            summary.add_member(member("visits", "number of calls of the call path",
+                                      otf2::common::type::uint64, "#"));
+            summary.add_member(member("inclusive time", "time spent in the call path",
+                                      otf2::common::type::Double, "s"));
+            summary.add_member(member("exclusive time",
+                                      "time spent in the call path without its callees",
+                                      otf2::common::type::Double, "s"));
+
+            return summary;
+        }
+
+    public:
+        void enter(otf2::chrono::time_point timestamp, OTF2_RegionRef region)
+        {
+            auto node = child(stack_.back().node, region);
+
+            nodes_[node].visits++;
+            stack_.push_back({ node, timestamp });
+
+            seen(timestamp);
+        }
+
+        void leave(otf2::chrono::time_point timestamp, OTF2_RegionRef region)
+        {
+            if (stack_.size() == 1 || nodes_[stack_.back().node].region != region)
+            {
+                make_exception("Leave of region #", region, " doesn't match the current call path");
+            }
+
+            nodes_[stack_.back().node].inclusive += timestamp - stack_.back().enter;
+            stack_.pop_back();
+
+            seen(timestamp);
+        }
+
+        void metric(const otf2::event::metric& data)
+        {
+            auto& metrics = nodes_[stack_.back().node].metrics;
+
+            auto def = data.metric_def();
+            auto it = std::find_if(metrics.begin(), metrics.end(),
+                                   [&def](const auto& sum) { return sum.metric_def() == def; });
+
+            if (it == metrics.end())
+            {
+                metrics.push_back(data);
+            }
+            else
+            {
+                add(it->raw_values(), data.raw_values(), data.resolve_metric_class());
+            }
+
+            seen(data.timestamp());
+        }
+
+        /**
+         * \brief returns the number of call paths
+         */
+        std::size_t size() const
+        {
+            return nodes_.size() - 1;
+        }
+
+        /**
+         * \brief writes the profile with write_enter(), write() and write_leave() of the writer
+         *
+         * Call paths, which are still open, are closed at the latest timestamp first.
+         */
+        template <typename Writer>
+        void write(Writer& wrt)
+        {
+            while (stack_.size() > 1)
+            {
+                leave(last_, nodes_[stack_.back().node].region);
+            }
+
+            // parents are always created before their children, so walking backwards visits
+            // all children before their parent and keeps the children in order of creation
+            std::vector<std::uint32_t> first_child(nodes_.size(), 0);
+            std::vector<std::uint32_t> next_sibling(nodes_.size(), 0);
+            std::vector<otf2::chrono::duration> callees(nodes_.size(), otf2::chrono::duration(0));
+
+            for (auto i = static_cast<std::uint32_t>(nodes_.size()) - 1; i > 0; --i)
+            {
+                auto parent = nodes_[i].parent;
+
+                next_sibling[i] = first_child[parent];
+                first_child[parent] = i;
+                callees[parent] += nodes_[i].inclusive;
+            }
+
+            // a walk with an explicit stack, as call paths can be deeper than the native stack
+            struct walk
+            {
+                std::uint32_t node;
+                std::uint32_t next_child;
+            };
+
+            write_node(wrt, 0, callees);
+            std::vector<walk> path{ { 0, first_child[0] } };
+
+            while (!path.empty())
+            {
+                auto child = path.back().next_child;
+
+                if (child != 0)
+                {
+                    path.back().next_child = next_sibling[child];
+
+                    wrt.write_enter(last_, nodes_[child].region);
+                    write_node(wrt, child, callees);
+                    path.push_back({ child, first_child[child] });
+                }
+                else
+                {
+                    if (path.back().node != 0)
+                    {
+                        wrt.write_leave(last_, nodes_[path.back().node].region);
+                    }
+
+                    path.pop_back();
+                }
+            }
+        }
+
+    private:
+        struct frame
+        {
+            std::uint32_t node;
+            otf2::chrono::time_point enter;
+        };
+
+        // writes the summary and the metrics of the node, which is already entered
+        template <typename Writer>
+        void write_node(Writer& wrt, std::uint32_t node,
+                        const std::vector<otf2::chrono::duration>& callees) const
+        {
+            using seconds = std::chrono::duration<double>;
+
+            const auto& data = nodes_[node];
+
+            if (node != 0)
+            {
+                otf2::event::metric summary(last_, summary_);
+                summary.raw_values()[0] = data.visits;
+                summary.raw_values()[1] = seconds(data.inclusive).count();
+                summary.raw_values()[2] = seconds(data.inclusive - callees[node]).count();
+                wrt.write(summary);
+            }
+
+            for (const auto& aggregate : data.metrics)
+            {
+                wrt.write(otf2::event::metric(aggregate, last_));
+            }
+        }
+
+        std::uint32_t child(std::uint32_t parent, OTF2_RegionRef region)
+        {
+            auto key = (static_cast<std::uint64_t>(parent) << 32) | region;
+
+            auto it = children_.find(key);
+            if (it != children_.end())
+            {
+                return it->second;
+            }
+
+            auto node = static_cast<std::uint32_t>(nodes_.size());
+            nodes_.emplace_back(parent, region);
+            children_.emplace(key, node);
+
+            return node;
+        }
+
+        void seen(otf2::chrono::time_point timestamp)
+        {
+            if (timestamp > last_)
+            {
+                last_ = timestamp;
+            }
+        }
+
+        static void add(otf2::event::metric::values& sum, const otf2::event::metric::values& values,
+                        const otf2::definition::metric_class& metric_class)
+        {
+            if (!metric_class.is_valid())
+            {
+                make_exception("Cannot aggregate the values of a metric without metric class");
+            }
+
+            if (sum.size() != values.size() || metric_class.size() != values.size())
+            {
+                make_exception("Metric events of the same metric differ in their number of values");
+            }
+
+            for (std::size_t i = 0; i < sum.size(); ++i)
+            {
+                // only relative values are increments, the others are readings of a counter or
+                // gauge, which replace the previous ones
+                bool relative =
+                    metric_class[i].property() == otf2::common::metric_value_property::relative;
+
+                switch (sum[i].type())
+                {
+                case otf2::common::type::Double:
+                    sum[i] = (relative ? sum[i].as_double() : 0.0) + values[i].as_double();
+                    break;
+                case otf2::common::type::int64:
+                    sum[i] = (relative ? sum[i].as_int64() : 0) + values[i].as_int64();
+                    break;
+                default:
+                    sum[i] = (relative ? sum[i].as_uint64() : 0) + values[i].as_uint64();
+                    break;
+                }
+            }
+        }
+
+    private:
+        otf2::definition::metric_class summary_;
+
+        // nodes_[0] is the root of the call tree, which stands for no region at all
+        std::vector<detail::profile_node> nodes_;
+
+        // maps the parent node and the region to the node of the call path
+        std::unordered_map<std::uint64_t, std::uint32_t> children_;
+
+        std::vector<frame> stack_;
+        otf2::chrono::time_point last_ = otf2::chrono::genesis();
+    };
+} // namespace writer
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_WRITER_PROFILE_HPP
@@ -0,0 +1,574 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_REWRITER_HPP
+#define INCLUDE_OTF2XX_WRITER_REWRITER_HPP
+
+#include <otf2xx/reader/forwarding_callback.hpp>
+#include <otf2xx/reader/reader.hpp>
+#include <otf2xx/writer/archive.hpp>
+#include <otf2xx/writer/local.hpp>
+
+#include <otf2xx/chrono/chrono.hpp>
+#include <otf2xx/chrono/clock_correction.hpp>
+#include <otf2xx/definition/definitions.hpp>
+#include <otf2xx/event/events.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace otf2
+{
+namespace writer
+{
+
+    namespace detail
+    {
+        /**
+         * \brief forwards the events of a reader to another callback, but no definitions
+         */
+        class event_forwarder : public otf2::reader::forwarding_callback<event_forwarder>
+        {
+        public:
+            explicit event_forwarder(otf2::reader::callback& target) : target_(target)
+            {
+            }
+
+        private:
+            template <typename, typename>
+            friend class otf2::reader::detail::forwarding_callback_impl;
+
+            template <typename Event>
+            void forward(const otf2::definition::location& location, const Event& event)
+            {
+                target_.event(location, event);
+            }
+
+        private:
+            otf2::reader::callback& target_;
+        };
+    } // namespace detail
+
+    /**
+     * \brief copies a trace into an archive, passing every record through an overridable method
+     *
+     * By default, every definition is written to the registry of the archive with its reference
+     * unchanged, and every event is written to the local writer of its location. Derive from
+     * this class and override the definition() and event() methods to transform the trace, e.g.
+     * to rename strings or drop events. Call write() from the overrides for the records to keep.
+     * Locations, whose definition isn't written, are dropped with all of their events. Clock
+     * corrections set with set_clock_correction() are applied while reading.
+     *
+     * Events are streamed from the reader to the writers, so only the definitions are held in
+     * memory. With more than one thread, the locations are split between the threads, which each
+     * read their events with an own reader. Then, the events are only in order per location and
+     * the event() methods are called concurrently for different locations.
+     */
+    template <typename Registry>
+    class Rewriter : public otf2::reader::forwarding_callback<Rewriter<Registry>>
+    {
+    public:
+        /**
+         * \param input the path to the anchor file of the trace to read
+         * \param output the archive to write to, which has to be the master
+         */
+        Rewriter(const std::string& input, Archive<Registry>& output)
+        : input_(input), output_(output)
+        {
+        }
+
+    public:
+        /**
+         * \brief sets a correction for the clock of the given location, see otf2::reader::reader
+         */
+        void set_clock_correction(const otf2::definition::location& location,
+                                  otf2::chrono::clock_correction correction)
+        {
+            clock_corrections_.emplace_back(location, std::move(correction));
+        }
+
+        /**
+         * \brief reads the whole trace and writes it to the archive
+         *
+         * \param threads the number of threads reading events, only 1 with non-atomic
+         *        reference counts
+         */
+        void run(std::size_t threads = 1)
+        {
+#ifdef OTF2XX_NON_ATOMIC_REFCOUNT
+            if (threads > 1)
+            {
+                make_exception("Several threads need atomic reference counts, see "
+                               "OTF2XX_ATOMIC_REFCOUNT");
+            }
+#endif
+
+            otf2::reader::reader rdr(input_);
+            rdr.set_callback(*this);
+
+            rdr.read_definitions();
+            set_clock_corrections(rdr);
+
+            // create all local writers upfront, so the lookup is read-only while reading events
+            std::vector<otf2::definition::location> locations;
+            for (const auto& location : locations_)
+            {
+                writers_.emplace(location.first, &output_(location.second));
+                locations.push_back(location.second);
+            }
+
+            if (threads <= 1 || locations.size() <= 1)
+            {
+                for (const auto& location : locations)
+                {
+                    rdr.register_location(location);
+                }
+
+                rdr.read_events();
+                return;
+            }
+
+            std::vector<std::thread> workers;
+            std::exception_ptr error;
+            std::mutex error_mutex;
+
+            for (std::size_t t = 0; t < threads && t < locations.size(); ++t)
+            {
+                workers.emplace_back(
+                    [this, t, threads, &locations, &error, &error_mutex]()
+                    {
+                        try
+                        {
+                            read_events(locations, t, threads);
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lock(error_mutex);
+                            if (!error)
+                            {
+                                error = std::current_exception();
+                            }
+                        }
+                    });
+            }
+
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+
+            this->events_done(rdr);
+        }
+
+        /**
+         * \brief rewrites the definitions, but copies the event files of the trace verbatim
+         *
+         * Only the definitions are read and passed through the definition() methods. The event
+         * and local definition files of the written locations are hard linked into the archive,
+         * or copied, where that isn't possible. This is much faster than run(), but the trace
+         * is only valid, as long as the overrides keep the references of the definitions used
+         * by the events. The event() methods aren't called and clock corrections are rejected.
+         */
+        void run_definitions_only()
+        {
+            if (!clock_corrections_.empty())
+            {
+                make_exception("Clock corrections need the events to be rewritten");
+            }
+
+            if (output_.path().empty())
+            {
+                make_exception("The path of the archive is unknown");
+            }
+
+            copy_event_files_ = true;
+
+            otf2::reader::reader rdr(input_);
+            rdr.set_callback(*this);
+            rdr.read_definitions();
+
+            // the local files are in a directory named like the anchor file
+            auto from = std::filesystem::path(input_).replace_extension();
+            auto to = std::filesystem::path(output_.path()) / output_.name();
+
+            std::error_code error;
+            std::filesystem::create_directories(to, error);
+            if (error)
+            {
+                make_exception("Couldn't create the directory '", to.string(), "': ",
+                               error.message());
+            }
+
+            for (const auto& location : locations_)
+            {
+                for (const char* extension : { ".evt", ".def" })
+                {
+                    auto file = std::to_string(location.first) + extension;
+
+                    // locations without events or local definitions have no files
+                    if (std::filesystem::exists(from / file))
+                    {
+                        link_or_copy(from / file, to / file);
+                    }
+                }
+            }
+        }
+
+    public:
+        /**
+         * \brief writes the definition to the registry of the archive
+         */
+        template <typename Definition>
+        void write(const Definition& def)
+        {
+            output_ << def;
+        }
+
+        /**
+         * \brief writes a copy of the location definition, which counts the rewritten events
+         *
+         * If the event files are copied, the copy keeps the number of events of the trace.
+         */
+        void write(const otf2::definition::location& def)
+        {
+            otf2::definition::location location(def, copy_event_files_ ? def.num_events() : 0);
+
+            locations_.emplace(location.ref().get(), location);
+            output_ << location;
+        }
+
+        /**
+         * \brief writes the clock properties and keeps the timestamps of the trace unchanged
+         */
+        void write(const otf2::definition::clock_properties& def)
+        {
+            output_ << def;
+            output_.set_clock_convert(otf2::chrono::convert(def));
+        }
+
+        /**
+         * \brief writes the event to the local writer of the location, if it was written
+         */
+        template <typename Event>
+        void write(const otf2::definition::location& location, const Event& event)
+        {
+            auto it = writers_.find(location.ref().get());
+
+            if (it != writers_.end())
+            {
+                it->second->write(event);
+            }
+        }
+
+    public:
+        void definition(const otf2::definition::attribute& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::comm& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::inter_comm& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::locations_group& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::regions_group& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::comm_locations_group& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::comm_group& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::comm_self_group& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::location& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::location_group& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::parameter& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::region& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::string& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::system_tree_node& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::system_tree_node_domain& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::clock_properties& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::call_path& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::call_path_parameter& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::source_code_location& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::calling_context& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::interrupt_generator& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::rma_win& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::io_regular_file& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::io_directory& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::io_handle& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::io_paradigm& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::io_pre_created_handle_state& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::metric_class& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::metric_member& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::metric_instance& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::cart_dimension& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::cart_topology& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::cart_coordinate& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::location_property& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::location_group_property& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::system_tree_node_property& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::calling_context_property& def) override
+        {
+            write(def);
+        }
+
+        void definition(const otf2::definition::io_file_property& def) override
+        {
+            write(def);
+        }
+
+    private:
+        template <typename, typename>
+        friend class otf2::reader::detail::forwarding_callback_impl;
+
+        template <typename Event>
+        void forward(const otf2::definition::location& location, const Event& event)
+        {
+            write(location, event);
+        }
+
+    private:
+        void read_events(const std::vector<otf2::definition::location>& locations,
+                         std::size_t first, std::size_t stride)
+        {
+            otf2::reader::reader rdr(input_);
+
+            detail::event_forwarder forwarder(*this);
+            rdr.set_callback(forwarder);
+
+            rdr.read_definitions();
+            set_clock_corrections(rdr);
+
+            for (auto i = first; i < locations.size(); i += stride)
+            {
+                rdr.register_location(locations[i]);
+            }
+
+            rdr.read_events();
+        }
+
+        static void link_or_copy(const std::filesystem::path& from,
+                                 const std::filesystem::path& to)
+        {
+            std::error_code error;
+            std::filesystem::create_hard_link(from, to, error);
+
+            if (error)
+            {
+                // e.g. the archives are on different file systems
+                error.clear();
+                std::filesystem::copy_file(
+                    from, to, std::filesystem::copy_options::overwrite_existing, error);
+            }
+
+            if (error)
+            {
+                make_exception("Couldn't copy '", from.string(), "': ", error.message());
+            }
+        }
+
+        void set_clock_corrections(otf2::reader::reader& rdr) const
+        {
+            for (const auto& correction : clock_corrections_)
+            {
+                rdr.set_clock_correction(correction.first, correction.second);
+            }
+        }
+
+    private:
+        std::string input_;
+        Archive<Registry>& output_;
+
+        std::vector<std::pair<otf2::definition::location, otf2::chrono::clock_correction>>
+            clock_corrections_;
+
+        // set while the event files are copied instead of rewritten
+        bool copy_event_files_ = false;
+
+        // the written locations and their writers by reference
+        std::map<OTF2_LocationRef, otf2::definition::location> locations_;
+        std::unordered_map<OTF2_LocationRef, otf2::writer::local*> writers_;
+    };
+} // namespace writer
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_WRITER_REWRITER_HPP
@@ -0,0 +1,499 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_SPLITTER_HPP
+#define INCLUDE_OTF2XX_WRITER_SPLITTER_HPP
+
+#include <otf2xx/exception.hpp>
+#include <otf2xx/reader/forwarding_callback.hpp>
+#include <otf2xx/reader/reader.hpp>
+#include <otf2xx/registry.hpp>
+#include <otf2xx/writer/archive.hpp>
+#include <otf2xx/writer/local.hpp>
+
+#include <otf2xx/chrono/chrono.hpp>
+#include <otf2xx/definition/definitions.hpp>
+#include <otf2xx/event/events.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace otf2
+{
+namespace writer
+{
+
+    /**
+     * \brief splits a trace into archives of fixed time slices
+     *
+     * Every slice is written as an archive of its own with all definitions of the trace and
+     * clock properties covering the time of the slice. The timestamps of the events are kept
+     * unchanged. Slice i of the trace is written to the archive "<path>_<i>".
+     *
+     * The call stacks stay balanced in each slice: Regions still entered at the end of a slice
+     * are left at its end and entered again at the beginning of the next slice, with the same
+     * timestamp. Regions entered through a calling context are left and entered again through
+     * the same calling context. Locations without events in a slice get an empty event file.
+     *
+     * With more than one thread, the locations are split between the threads, which each read
+     * their events with an own reader. The archive of a slice is created, when the first location
+     * reaches it, and closed, once all locations have passed it. So only the slices between the
+     * slowest and the fastest location are open at a time, and each location only keeps the
+     * writer of its current slice.
+     */
+    template <typename Registry>
+    class Splitter : public otf2::reader::forwarding_callback<Splitter<Registry>>
+    {
+    public:
+        /**
+         * \param input the path to the anchor file of the trace to read
+         * \param path the path prefix of the archives of the slices
+         * \param name the name of the archives of the slices
+         * \param slice the duration of each slice
+         */
+        Splitter(const std::string& input, const std::string& path, const std::string& name,
+                 otf2::chrono::duration slice)
+        : input_(input), path_(path), name_(name), slice_(slice)
+        {
+            if (slice_.count() <= 0)
+            {
+                make_exception("The duration of a slice has to be positive");
+            }
+        }
+
+    public:
+        /**
+         * \brief reads the whole trace and writes its slices
+         *
+         * \param threads the number of threads reading events, only 1 with non-atomic
+         *        reference counts
+         */
+        void run(std::size_t threads = 1)
+        {
+#ifdef OTF2XX_NON_ATOMIC_REFCOUNT
+            if (threads > 1)
+            {
+                make_exception("Several threads need atomic reference counts, see "
+                               "OTF2XX_ATOMIC_REFCOUNT");
+            }
+#endif
+
+            otf2::reader::reader rdr(input_);
+            rdr.set_callback(*this);
+            rdr.read_definitions();
+
+            if (!rdr.has_clock_properties())
+            {
+                make_exception("The trace '", input_, "' has no clock properties");
+            }
+
+            create_slices(rdr.registry(), rdr.clock_properties());
+
+            std::vector<otf2::definition::location> locations;
+            for (const auto& location : rdr.registry().all<otf2::definition::location>())
+            {
+                auto& state = locations_[location.ref().get()];
+                state.writer = &slice_writer(0, location);
+
+                locations.push_back(location);
+            }
+
+            threads = std::max<std::size_t>(1, std::min(threads, locations.size()));
+
+            std::vector<std::thread> workers;
+            std::exception_ptr error;
+            std::mutex error_mutex;
+
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+                workers.emplace_back(
+                    [this, t, threads, &locations, &error, &error_mutex]()
+                    {
+                        try
+                        {
+                            read_events(locations, t, threads);
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lock(error_mutex);
+                            if (!error)
+                            {
+                                error = std::current_exception();
+                            }
+                        }
+                    });
+            }
+
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+
+            // close the archives of the last slice, so they are complete once this returns
+            slices_.clear();
+            definitions_ = nullptr;
+        }
+
+        /**
+         * \brief returns the number of slices, which is known after run() read the definitions
+         */
+        std::size_t num_slices() const
+        {
+            return num_slices_;
+        }
+
+    public:
+        using otf2::reader::forwarding_callback<Splitter<Registry>>::event;
+
+        void event(const otf2::definition::location& location,
+                   const otf2::event::enter& event) override
+        {
+            write(location, event).stack.push_back(frame{ event.region() });
+        }
+
+        void event(const otf2::definition::location& location,
+                   const otf2::event::leave& event) override
+        {
+            pop(write(location, event));
+        }
+
+        void event(const otf2::definition::location& location,
+                   const otf2::event::calling_context_enter& event) override
+        {
+            write(location, event)
+                .stack.push_back(frame{ event.calling_context().region(), event.calling_context(),
+                                        event.unwind_distance() });
+        }
+
+        void event(const otf2::definition::location& location,
+                   const otf2::event::calling_context_leave& event) override
+        {
+            pop(write(location, event));
+        }
+
+    private:
+        template <typename, typename>
+        friend class otf2::reader::detail::forwarding_callback_impl;
+
+        template <typename Event>
+        void forward(const otf2::definition::location& location, const Event& event)
+        {
+            write(location, event);
+        }
+
+    private:
+        struct slice
+        {
+            // created by the first location reaching the slice, closed by the last one leaving it
+            std::unique_ptr<Archive<Registry>> archive;
+
+            // the copies of the locations in this slice, which count its events
+            std::map<OTF2_LocationRef, otf2::definition::location> locations;
+
+            // the number of locations, which haven't left the slice yet
+            std::size_t pending = 0;
+        };
+
+        struct frame
+        {
+            otf2::definition::region region;
+
+            // only valid, if the region was entered through a calling context
+            otf2::definition::calling_context calling_context;
+            std::uint32_t unwind_distance = 0;
+        };
+
+        struct location_state
+        {
+            std::size_t slice = 0;
+            otf2::writer::local* writer = nullptr;
+
+            // the regions entered, but not yet left
+            std::vector<frame> stack;
+        };
+
+        static void pop(location_state& state)
+        {
+            if (!state.stack.empty())
+            {
+                state.stack.pop_back();
+            }
+        }
+
+        template <typename... Definitions>
+        static void copy(const otf2::registry& reg, Archive<Registry>& ar)
+        {
+            ((ar << reg.template all<Definitions>().data()), ...);
+        }
+
+        void create_slices(const otf2::registry& reg,
+                           const otf2::definition::clock_properties& clock)
+        {
+            otf2::chrono::convert to_time(clock.ticks_per_second());
+
+            auto length = to_time(clock.length()).time_since_epoch();
+            num_slices_ = std::max<std::size_t>(1, (length + slice_ - otf2::chrono::duration(1)) /
+                                                       slice_);
+
+            definitions_ = &reg;
+            clock_ = clock;
+
+            slices_.clear();
+            slices_.resize(num_slices_);
+        }
+
+        // has to be called with slices_mutex_ locked, as it copies the shared definitions
+        void open_slice(std::size_t i)
+        {
+            const auto& reg = *definitions_;
+            const auto& clock = clock_;
+            otf2::chrono::convert to_ticks(clock);
+
+            auto& current = slices_[i];
+            current.archive =
+                std::make_unique<Archive<Registry>>(path_ + "_" + std::to_string(i), name_);
+
+            auto& ar = *current.archive;
+
+            copy<otf2::definition::string, otf2::definition::attribute,
+                 otf2::definition::system_tree_node, otf2::definition::system_tree_node_property,
+                 otf2::definition::system_tree_node_domain, otf2::definition::location_group,
+                 otf2::definition::location_group_property>(reg, ar);
+
+            for (const auto& def : reg.template all<otf2::definition::location>())
+            {
+                otf2::definition::location location(def, 0);
+
+                current.locations.emplace(location.ref().get(), location);
+                ar << location;
+            }
+
+            current.pending = current.locations.size();
+
+            copy<otf2::definition::location_property, otf2::definition::region,
+                 otf2::definition::comm_locations_group, otf2::definition::comm_self_group,
+                 otf2::definition::comm_group, otf2::definition::locations_group,
+                 otf2::definition::regions_group, otf2::definition::comm,
+                 otf2::definition::inter_comm, otf2::definition::parameter,
+                 otf2::definition::call_path, otf2::definition::call_path_parameter,
+                 otf2::definition::cart_topology, otf2::definition::cart_dimension,
+                 otf2::definition::cart_coordinate, otf2::definition::rma_win,
+                 otf2::definition::source_code_location, otf2::definition::calling_context,
+                 otf2::definition::calling_context_property, otf2::definition::interrupt_generator,
+                 otf2::definition::metric_member, otf2::definition::metric_class,
+                 otf2::definition::metric_instance, otf2::definition::io_paradigm,
+                 otf2::definition::io_directory, otf2::definition::io_regular_file,
+                 otf2::definition::io_file_property, otf2::definition::io_handle,
+                 otf2::definition::io_pre_created_handle_state, otf2::definition::marker>(reg, ar);
+
+            auto begin = to_ticks(boundary(i)).count();
+            auto end = clock.start_time().count() + clock.length().count();
+            if (i + 1 < num_slices_)
+            {
+                end = to_ticks(boundary(i + 1)).count();
+            }
+
+            auto realtime = clock.realtime_timestamp().count();
+            if (realtime != OTF2_UNDEFINED_TIMESTAMP)
+            {
+                // the realtime timestamp is in nanoseconds
+                realtime += static_cast<std::uint64_t>(
+                    std::llround(static_cast<long double>(begin - clock.start_time().count()) *
+                                 1e9L / clock.ticks_per_second().count()));
+            }
+
+            ar << otf2::definition::clock_properties(
+                clock.ticks_per_second(), otf2::chrono::ticks(begin),
+                otf2::chrono::ticks(end - begin), otf2::chrono::ticks(realtime));
+
+            // keep the ticks of the trace, instead of starting each slice at zero
+            ar.set_clock_convert(to_ticks);
+        }
+
+        otf2::chrono::time_point boundary(std::size_t slice) const
+        {
+            return otf2::chrono::time_point(slice_ * slice);
+        }
+
+        otf2::writer::local& slice_writer(std::size_t slice,
+                                          const otf2::definition::location& location)
+        {
+            std::lock_guard<std::mutex> lock(slices_mutex_);
+
+            if (!slices_[slice].archive)
+            {
+                open_slice(slice);
+            }
+
+            return (*slices_[slice].archive)(slices_[slice].locations.at(location.ref().get()));
+        }
+
+        void leave_slice(std::size_t slice, const otf2::definition::location& location)
+        {
+            std::lock_guard<std::mutex> lock(slices_mutex_);
+
+            auto& current = slices_[slice];
+            current.archive->close_local_writer(current.locations.at(location.ref().get()));
+
+            if (--current.pending == 0)
+            {
+                current.archive.reset();
+                current.locations.clear();
+            }
+        }
+
+        /**
+         * \brief moves the location to the slice of the timestamp and returns its state
+         *
+         * The writers of the slices left behind are closed, after the stack was left in them, and
+         * so are the slices, which all locations have left.
+         */
+        location_state& advance(const otf2::definition::location& location,
+                                otf2::chrono::time_point timestamp)
+        {
+            auto& state = locations_.at(location.ref().get());
+
+            auto target = std::min<std::size_t>(
+                num_slices_ - 1,
+                static_cast<std::size_t>(std::max<otf2::chrono::duration::rep>(
+                    0, timestamp.time_since_epoch() / slice_)));
+
+            while (state.slice < target)
+            {
+                auto end = boundary(state.slice + 1);
+
+                for (auto entry = state.stack.rbegin(); entry != state.stack.rend(); ++entry)
+                {
+                    if (entry->calling_context.is_valid())
+                    {
+                        state.writer->write(
+                            otf2::event::calling_context_leave(end, entry->calling_context));
+                    }
+                    else
+                    {
+                        state.writer->write(otf2::event::leave(end, entry->region));
+                    }
+                }
+
+                leave_slice(state.slice, location);
+
+                state.slice++;
+                state.writer = &slice_writer(state.slice, location);
+
+                for (const auto& entry : state.stack)
+                {
+                    if (entry.calling_context.is_valid())
+                    {
+                        state.writer->write(otf2::event::calling_context_enter(
+                            end, entry.calling_context, entry.unwind_distance));
+                    }
+                    else
+                    {
+                        state.writer->write(otf2::event::enter(end, entry.region));
+                    }
+                }
+            }
+
+            return state;
+        }
+
+        template <typename Event>
+        location_state& write(const otf2::definition::location& location, const Event& event)
+        {
+            auto& state = advance(location, event.timestamp());
+
+            state.writer->write(event);
+
+            return state;
+        }
+
+        void read_events(const std::vector<otf2::definition::location>& locations,
+                         std::size_t first, std::size_t stride)
+        {
+            otf2::reader::reader rdr(input_);
+            rdr.set_callback(*this);
+            rdr.read_definitions();
+
+            for (auto i = first; i < locations.size(); i += stride)
+            {
+                rdr.register_location(locations[i]);
+            }
+
+            rdr.read_events();
+
+            // give the locations an event file in the remaining slices, balancing their stacks
+            for (auto i = first; i < locations.size(); i += stride)
+            {
+                advance(locations[i], boundary(num_slices_ - 1));
+            }
+        }
+
+    private:
+        std::string input_;
+        std::string path_;
+        std::string name_;
+        otf2::chrono::duration slice_;
+
+        std::size_t num_slices_ = 0;
+
+        // the definitions and the clock of the trace, while run() reads it
+        const otf2::registry* definitions_ = nullptr;
+        otf2::definition::clock_properties clock_;
+
+        std::mutex slices_mutex_;
+        std::vector<slice> slices_;
+
+        // only the thread reading the events of a location changes its state
+        std::map<OTF2_LocationRef, location_state> locations_;
+    };
+
+    using splitter = Splitter<otf2::registry>;
+} // namespace writer
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_WRITER_SPLITTER_HPP
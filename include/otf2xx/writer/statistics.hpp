@@ -0,0 +1,351 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_STATISTICS_HPP
+#define INCLUDE_OTF2XX_WRITER_STATISTICS_HPP
+
+#include <otf2xx/common.hpp>
+#include <otf2xx/definition/metric_class.hpp>
+#include <otf2xx/definition/metric_member.hpp>
+#include <otf2xx/definition/string.hpp>
+#include <otf2xx/tmp/algorithm.hpp>
+#include <otf2xx/traits/event.hpp>
+
+#include <otf2/OTF2_GeneralDefinitions.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace otf2
+{
+namespace writer
+{
+
+    class statistics;
+
+    namespace detail
+    {
+        /**
+         * \brief a counter, which is changed by one thread, but can be read by any thread
+         *
+         * As there is only one writing thread, an increment is a relaxed load and store, which
+         * is as cheap as a plain integer, instead of a locked read-modify-write.
+         */
+        class counter
+        {
+        public:
+            counter() = default;
+
+            counter(const counter& other) : value_(other.get())
+            {
+            }
+
+            counter& operator=(const counter& other)
+            {
+                value_.store(other.get(), std::memory_order_relaxed);
+                return *this;
+            }
+
+            void add(std::uint64_t n)
+            {
+                value_.store(value_.load(std::memory_order_relaxed) + n,
+                             std::memory_order_relaxed);
+            }
+
+            std::uint64_t get() const
+            {
+                return value_.load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<std::uint64_t> value_{ 0 };
+        };
+
+        /**
+         * \brief returns the statistics of the writer, which currently writes on this thread
+         *
+         * OTF2 flushes the buffers of the writers from within their write calls, so the flush
+         * callback of the archive finds the statistics of the flushing writer here.
+         */
+        inline statistics*& active_statistics()
+        {
+            thread_local statistics* active = nullptr;
+            return active;
+        }
+    } // namespace detail
+
+    /**
+     * \brief counts the work done by a local writer
+     *
+     * The counters are kept by the local writer, while it is open, see
+     * otf2::writer::local::enable_statistics(). They are only changed by the thread writing the
+     * events, but can be read from any thread at any time.
+     *
+     * The write time is spent within the OTF2 calls writing events, including the flushes of the
+     * event buffer. The flush time is the part of it, which was spent in write calls that
+     * flushed the buffer.
+     */
+    class statistics
+    {
+        using clock = std::chrono::steady_clock;
+
+        using events_type = otf2::traits::all_events;
+
+    public:
+        statistics() = default;
+
+        /**
+         * \brief copies the counters, which may be done by any thread
+         *
+         * The state of the write call in progress and the last timestamp belong to the writing
+         * thread, so they aren't copied.
+         */
+        statistics(const statistics& other)
+        : events_(other.events_), flushes_(other.flushes_), flush_time_(other.flush_time_),
+          write_time_(other.write_time_), bytes_(other.bytes_)
+        {
+        }
+
+        statistics& operator=(const statistics& other)
+        {
+            events_ = other.events_;
+            flushes_ = other.flushes_;
+            flush_time_ = other.flush_time_;
+            write_time_ = other.write_time_;
+            bytes_ = other.bytes_;
+
+            return *this;
+        }
+
+        ~statistics()
+        {
+            // a write call, which threw, leaves its statistics active
+            if (detail::active_statistics() == this)
+            {
+                detail::active_statistics() = nullptr;
+            }
+        }
+
+    public:
+        /**
+         * \brief returns the number of events of the given type
+         */
+        template <typename Event>
+        std::uint64_t events() const
+        {
+            return events_[otf2::tmp::index_of<events_type, Event>::value].get();
+        }
+
+        /**
+         * \brief returns the number of events of all types
+         */
+        std::uint64_t events() const
+        {
+            std::uint64_t result = 0;
+
+            for (const auto& count : events_)
+            {
+                result += count.get();
+            }
+
+            return result;
+        }
+
+        std::uint64_t flushes() const
+        {
+            return flushes_.get();
+        }
+
+        std::chrono::nanoseconds flush_time() const
+        {
+            return std::chrono::nanoseconds(flush_time_.get());
+        }
+
+        std::chrono::nanoseconds write_time() const
+        {
+            return std::chrono::nanoseconds(write_time_.get());
+        }
+
+        /**
+         * \brief returns the size of the event file, as far as it was flushed
+         *
+         * This is only known for the statistics returned by otf2::writer::Archive.
+         */
+        std::uint64_t bytes() const
+        {
+            return bytes_;
+        }
+
+        /**
+         * \brief adds the counters of other writers, e.g. to get the totals of an archive
+         */
+        statistics& operator+=(const statistics& other)
+        {
+            for (std::size_t i = 0; i < events_.size(); ++i)
+            {
+                events_[i].add(other.events_[i].get());
+            }
+
+            flushes_.add(other.flushes_.get());
+            flush_time_.add(other.flush_time_.get());
+            write_time_.add(other.write_time_.get());
+            bytes_ += other.bytes_;
+
+            return *this;
+        }
+
+        /**
+         * \brief creates the metric class for writing statistics to the trace
+         *
+         * The members are the number of events, the number of flushes, the flush time and the
+         * write time, see otf2::writer::local::enable_statistics().
+         */
+        template <typename Registry>
+        static const otf2::definition::metric_class& make_metrics(Registry& reg)
+        {
+            auto& metrics = reg.template create<otf2::definition::metric_class>(
+                otf2::common::metric_occurence::async, otf2::common::recorder_kind::abstract);
+
+            auto member = [&reg](const char* name, const char* description,
+                                 otf2::common::type type, const char* unit)
+            {
+                return reg.template create<otf2::definition::metric_member>(
+                    reg.template create<otf2::definition::string>(name),
+                    reg.template create<otf2::definition::string>(description),
+                    otf2::common::metric_type::other, otf2::common::metric_mode::accumulated_start,
+                    type, otf2::common::base_type::decimal, 0,
+                    reg.template create<otf2::definition::string>(unit));
+            };
+
+            metrics.add_member(member("otf2xx events", "number of events written by otf2xx",
+                                      otf2::common::type::uint64, "#"));
+            metrics.add_member(member("otf2xx flushes", "number of event buffer flushes",
+                                      otf2::common::type::uint64, "#"));
+            metrics.add_member(member("otf2xx flush time", "time spent flushing event buffers",
+                                      otf2::common::type::Double, "s"));
+            metrics.add_member(member("otf2xx write time", "time spent writing events to OTF2",
+                                      otf2::common::type::Double, "s"));
+
+            return metrics;
+        }
+
+    public:
+        /**
+         * \brief marks the begin of an OTF2 call writing events
+         * \internal
+         */
+        void begin_write()
+        {
+            begin_ = clock::now();
+            flushed_ = false;
+            detail::active_statistics() = this;
+        }
+
+        /**
+         * \brief marks the end of an OTF2 call, which wrote count events of the given type
+         * \internal
+         */
+        template <typename Event>
+        void end_write(OTF2_TimeStamp timestamp, std::uint64_t count = 1)
+        {
+            end_write();
+
+            events_[otf2::tmp::index_of<events_type, Event>::value].add(count);
+            last_timestamp_ = timestamp;
+        }
+
+        /**
+         * \brief marks the end of an OTF2 call, which didn't write events, e.g. closing
+         * \internal
+         */
+        void end_write()
+        {
+            auto duration =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - begin_);
+
+            write_time_.add(duration.count());
+            if (flushed_)
+            {
+                flush_time_.add(duration.count());
+            }
+
+            detail::active_statistics() = nullptr;
+        }
+
+        /**
+         * \brief counts a flush of the event buffer, called from the flush callback
+         * \internal
+         */
+        void flushing()
+        {
+            flushes_.add(1);
+            flushed_ = true;
+        }
+
+        /**
+         * \brief sets the size of the event file
+         * \internal
+         */
+        void set_bytes(std::uint64_t bytes)
+        {
+            bytes_ = bytes;
+        }
+
+        /**
+         * \brief returns the timestamp of the last event in ticks
+         */
+        OTF2_TimeStamp last_timestamp() const
+        {
+            return last_timestamp_;
+        }
+
+    private:
+        std::array<detail::counter, otf2::tmp::size<events_type>::value> events_;
+        detail::counter flushes_;
+        detail::counter flush_time_;
+        detail::counter write_time_;
+        std::uint64_t bytes_ = 0;
+
+        // only used by the writing thread
+        clock::time_point begin_;
+        bool flushed_ = false;
+        OTF2_TimeStamp last_timestamp_ = 0;
+    };
+} // namespace writer
+} // namespace otf2
+
+#endif // INCLUDE_OTF2XX_WRITER_STATISTICS_HPP
@@ -0,0 +1,531 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef INCLUDE_OTF2XX_WRITER_UNIFICATION_HPP
+#define INCLUDE_OTF2XX_WRITER_UNIFICATION_HPP
+
+#ifdef OTF2XX_HAS_MPI
+
+#include <otf2xx/common.hpp>
+#include <otf2xx/definition/mapping_table.hpp>
+#include <otf2xx/definition/region.hpp>
+#include <otf2xx/definition/string.hpp>
+#include <otf2xx/exception.hpp>
+
+#include <otf2/OTF2_GeneralDefinitions.h>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace otf2
+{
+namespace writer
+{
+
+    namespace detail
+    {
+        // message tag used by the unification, its own communicator keeps it apart from the
+        // messages of the application
+        constexpr int unification_tag = 1;
+
+        inline void send_keys(MPI_Comm comm, const std::vector<std::string>& keys, int dest)
+        {
+            std::vector<char> buffer;
+
+            for (const auto& key : keys)
+            {
+                auto size = static_cast<std::uint32_t>(key.size());
+                auto pos = buffer.size();
+
+                buffer.resize(pos + sizeof(size) + key.size());
+                std::memcpy(buffer.data() + pos, &size, sizeof(size));
+                std::memcpy(buffer.data() + pos + sizeof(size), key.data(), key.size());
+            }
+
+            MPI_Send(buffer.data(), static_cast<int>(buffer.size()), MPI_BYTE, dest,
+                     unification_tag, comm);
+        }
+
+        inline std::vector<std::string> receive_keys(MPI_Comm comm, int source)
+        {
+            MPI_Status status;
+            MPI_Probe(source, unification_tag, comm, &status);
+
+            int count;
+            MPI_Get_count(&status, MPI_BYTE, &count);
+
+            std::vector<char> buffer(count);
+            MPI_Recv(buffer.data(), count, MPI_BYTE, source, unification_tag, comm,
+                     MPI_STATUS_IGNORE);
+
+            std::vector<std::string> keys;
+
+            for (std::size_t pos = 0; pos < buffer.size();)
+            {
+                std::uint32_t size;
+                std::memcpy(&size, buffer.data() + pos, sizeof(size));
+                pos += sizeof(size);
+
+                keys.emplace_back(buffer.data() + pos, size);
+                pos += size;
+            }
+
+            return keys;
+        }
+
+        /**
+         * \brief returns the ids of the subset, given the ids of the sorted keys
+         */
+        inline std::vector<std::uint32_t> lookup_ids(const std::vector<std::string>& keys,
+                                                     const std::vector<std::uint32_t>& ids,
+                                                     const std::vector<std::string>& subset)
+        {
+            std::vector<std::uint32_t> result;
+            result.reserve(subset.size());
+
+            auto it = keys.begin();
+            for (const auto& key : subset)
+            {
+                it = std::lower_bound(it, keys.end(), key);
+                result.push_back(ids[it - keys.begin()]);
+            }
+
+            return result;
+        }
+
+        /**
+         * \brief assigns global ids to the given keys of all ranks of the communicator
+         *
+         * The keys of every rank have to be sorted and unique. They are merged up a binomial tree
+         * to rank 0, which numbers their union in sorted order. The ids are sent down the same
+         * tree, where every rank only gets the ids of the keys of its subtree. Both directions
+         * take ceil(log2(P)) rounds and no rank holds more than the keys of its subtree.
+         *
+         * This is collective over the communicator.
+         *
+         * \param[out] global_keys the union of all keys on rank 0, empty on other ranks
+         * \returns the global id of each key
+         */
+        inline std::vector<std::uint32_t> unify_keys(MPI_Comm comm,
+                                                     const std::vector<std::string>& keys,
+                                                     std::vector<std::string>& global_keys)
+        {
+            int rank, size;
+            MPI_Comm_rank(comm, &rank);
+            MPI_Comm_size(comm, &size);
+
+            std::vector<std::string> subtree = keys;
+            std::vector<std::pair<int, std::vector<std::string>>> children;
+            int parent = -1;
+
+            for (int mask = 1; mask < size; mask <<= 1)
+            {
+                if (rank & mask)
+                {
+                    parent = rank - mask;
+                    send_keys(comm, subtree, parent);
+                    break;
+                }
+
+                if (rank + mask < size)
+                {
+                    auto child = receive_keys(comm, rank + mask);
+
+                    std::vector<std::string> merged;
+                    merged.reserve(subtree.size() + child.size());
+                    std::set_union(subtree.begin(), subtree.end(), child.begin(), child.end(),
+                                   std::back_inserter(merged));
+
+                    subtree = std::move(merged);
+                    children.emplace_back(rank + mask, std::move(child));
+                }
+            }
+
+            std::vector<std::uint32_t> ids(subtree.size());
+
+            if (parent < 0)
+            {
+                std::iota(ids.begin(), ids.end(), 0);
+            }
+            else
+            {
+                MPI_Recv(ids.data(), static_cast<int>(ids.size()), MPI_UINT32_T, parent,
+                         unification_tag, comm, MPI_STATUS_IGNORE);
+            }
+
+            for (const auto& child : children)
+            {
+                auto child_ids = lookup_ids(subtree, ids, child.second);
+
+                MPI_Send(child_ids.data(), static_cast<int>(child_ids.size()), MPI_UINT32_T,
+                         child.first, unification_tag, comm);
+            }
+
+            auto result = lookup_ids(subtree, ids, keys);
+
+            global_keys.clear();
+            if (parent < 0)
+            {
+                global_keys = std::move(subtree);
+            }
+
+            return result;
+        }
+
+        template <typename Type>
+        void append_key(std::string& key, Type value)
+        {
+            key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        template <typename Type>
+        Type read_key(const std::string& key, std::size_t& pos)
+        {
+            Type value;
+            std::memcpy(&value, key.data() + pos, sizeof(value));
+            pos += sizeof(value);
+            return value;
+        }
+    } // namespace detail
+
+    /**
+     * \brief unifies the string and region definitions of all ranks into one global id space
+     *
+     * Every rank defines its strings and regions in its own registry with its own references.
+     * unify() deduplicates them by content across the communicator. Afterwards, every rank
+     * writes the mapping from its local to the global references with write_mappings() to the
+     * local writers of its locations, and rank 0 adds the unified definitions to the registry of
+     * the archive with write_definitions().
+     */
+    class unification
+    {
+    public:
+        /**
+         * \brief the global reference of each local reference, sorted by the local one
+         */
+        using mapping_type = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+        /**
+         * \brief duplicates the communicator for the messages of the unification
+         *
+         * This is collective over the communicator.
+         */
+        explicit unification(MPI_Comm comm)
+        {
+            MPI_Comm_dup(comm, &comm_);
+        }
+
+        unification(const unification&) = delete;
+        unification& operator=(const unification&) = delete;
+
+        ~unification()
+        {
+            int finalized;
+            MPI_Finalized(&finalized);
+
+            if (!finalized)
+            {
+                MPI_Comm_free(&comm_);
+            }
+        }
+
+    public:
+        /**
+         * \brief unifies the definitions of the given registry with the ones of the other ranks
+         *
+         * This is collective over the communicator.
+         */
+        template <typename Registry>
+        void unify(const Registry& reg)
+        {
+            string_mapping_ =
+                unify(reg.template all<otf2::definition::string>(),
+                      [](const otf2::definition::string& str) { return str.str(); }, strings_);
+
+            region_mapping_ =
+                unify(reg.template all<otf2::definition::region>(),
+                      [this](const otf2::definition::region& region)
+                      {
+                          std::string key;
+                          detail::append_key(key, global_ref(region.name()));
+                          detail::append_key(key, global_ref(region.canonical_name()));
+                          detail::append_key(key, global_ref(region.description()));
+                          detail::append_key(key, global_ref(region.source_file()));
+                          detail::append_key(key, static_cast<std::uint32_t>(region.role()));
+                          detail::append_key(key, static_cast<std::uint32_t>(region.paradigm()));
+                          detail::append_key(key, static_cast<std::uint32_t>(region.flags()));
+                          detail::append_key(key, region.begin_line());
+                          detail::append_key(key, region.end_line());
+                          return key;
+                      },
+                      regions_);
+        }
+
+        /**
+         * \brief writes the mapping tables of this rank to the given local writer
+         */
+        template <typename Writer>
+        void write_mappings(Writer& wrt) const
+        {
+            if (!string_mapping_.empty())
+            {
+                wrt.write(
+                    make_mapping_table(otf2::common::mapping_type_type::string, string_mapping_));
+            }
+            if (!region_mapping_.empty())
+            {
+                wrt.write(
+                    make_mapping_table(otf2::common::mapping_type_type::region, region_mapping_));
+            }
+        }
+
+        /**
+         * \brief creates the unified definitions with their global references in the registry
+         *
+         * Only rank 0 holds the unified definitions. Their global references start at 0, so the
+         * registry must not contain any string or region with one of these references yet.
+         */
+        template <typename Registry>
+        void write_definitions(Registry& reg) const
+        {
+            int rank;
+            MPI_Comm_rank(comm_, &rank);
+
+            if (rank != 0)
+            {
+                make_exception("Only rank 0 holds the unified definitions");
+            }
+
+            // creating a definition with an existing reference would silently keep the old one
+            for (std::size_t i = 0; i < strings_.size(); ++i)
+            {
+                if (reg.template has<otf2::definition::string>(
+                        otf2::definition::string::reference_type(i)))
+                {
+                    make_exception("The registry already contains a string with the reference ",
+                                   i);
+                }
+            }
+
+            for (std::size_t i = 0; i < regions_.size(); ++i)
+            {
+                if (reg.template has<otf2::definition::region>(
+                        otf2::definition::region::reference_type(i)))
+                {
+                    make_exception("The registry already contains a region with the reference ",
+                                   i);
+                }
+            }
+
+            std::vector<otf2::definition::string> strings;
+            strings.reserve(strings_.size());
+
+            for (std::size_t i = 0; i < strings_.size(); ++i)
+            {
+                strings.push_back(reg.template create<otf2::definition::string>(
+                    otf2::definition::string::reference_type(i), strings_[i]));
+            }
+
+            // the regions refer to undefined strings with OTF2_UNDEFINED_STRING
+            otf2::definition::string undefined;
+            auto string_at = [&](std::uint32_t id) -> const otf2::definition::string&
+            { return id == OTF2_UNDEFINED_STRING ? undefined : strings.at(id); };
+
+            for (std::size_t i = 0; i < regions_.size(); ++i)
+            {
+                std::size_t pos = 0;
+                const auto& key = regions_[i];
+
+                const auto& name = string_at(detail::read_key<std::uint32_t>(key, pos));
+                const auto& canonical_name = string_at(detail::read_key<std::uint32_t>(key, pos));
+                const auto& description = string_at(detail::read_key<std::uint32_t>(key, pos));
+                const auto& source_file = string_at(detail::read_key<std::uint32_t>(key, pos));
+                auto role = detail::read_key<std::uint32_t>(key, pos);
+                auto paradigm = detail::read_key<std::uint32_t>(key, pos);
+                auto flags = detail::read_key<std::uint32_t>(key, pos);
+                auto begin_line = detail::read_key<std::uint32_t>(key, pos);
+                auto end_line = detail::read_key<std::uint32_t>(key, pos);
+
+                reg.template create<otf2::definition::region>(
+                    otf2::definition::region::reference_type(i), name, canonical_name, description,
+                    static_cast<otf2::definition::region::role_type>(role),
+                    static_cast<otf2::definition::region::paradigm_type>(paradigm),
+                    static_cast<otf2::definition::region::flags_type>(flags), source_file,
+                    begin_line, end_line);
+            }
+        }
+
+    public:
+        /**
+         * \brief returns the global reference of each local string reference
+         */
+        const mapping_type& string_mapping() const
+        {
+            return string_mapping_;
+        }
+
+        /**
+         * \brief returns the global reference of each local region reference
+         */
+        const mapping_type& region_mapping() const
+        {
+            return region_mapping_;
+        }
+
+        /**
+         * \brief returns the global reference of the given string
+         *
+         * Strings, which weren't unified, are mapped to OTF2_UNDEFINED_STRING.
+         */
+        std::uint32_t global_ref(const otf2::definition::string& str) const
+        {
+            return find(string_mapping_, str.ref().get(), OTF2_UNDEFINED_STRING);
+        }
+
+        /**
+         * \brief returns the global reference of the given region
+         *
+         * Regions, which weren't unified, are mapped to OTF2_UNDEFINED_REGION.
+         */
+        std::uint32_t global_ref(const otf2::definition::region& region) const
+        {
+            return find(region_mapping_, region.ref().get(), OTF2_UNDEFINED_REGION);
+        }
+
+    private:
+        template <typename Definitions, typename Key>
+        mapping_type unify(const Definitions& defs, Key&& make_key,
+                           std::vector<std::string>& global_keys)
+        {
+            std::vector<std::pair<std::string, std::uint32_t>> entries;
+
+            for (const auto& def : defs)
+            {
+                entries.emplace_back(make_key(def), def.ref().get());
+            }
+
+            std::vector<std::string> keys;
+            keys.reserve(entries.size());
+            for (const auto& entry : entries)
+            {
+                keys.push_back(entry.first);
+            }
+
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+            auto ids = detail::unify_keys(comm_, keys, global_keys);
+
+            // only the defined local references, as they may be sparse
+            mapping_type mapping;
+            mapping.reserve(entries.size());
+
+            for (const auto& entry : entries)
+            {
+                auto it = std::lower_bound(keys.begin(), keys.end(), entry.first);
+                mapping.emplace_back(entry.second, ids[it - keys.begin()]);
+            }
+
+            std::sort(mapping.begin(), mapping.end());
+
+            return mapping;
+        }
+
+        static std::uint32_t find(const mapping_type& mapping, std::uint32_t local,
+                                  std::uint32_t undefined)
+        {
+            auto it = std::lower_bound(mapping.begin(), mapping.end(),
+                                       std::make_pair(local, std::uint32_t(0)));
+
+            if (it == mapping.end() || it->first != local)
+            {
+                return undefined;
+            }
+
+            return it->second;
+        }
+
+        static otf2::definition::mapping_table
+        make_mapping_table(otf2::common::mapping_type_type type, const mapping_type& mapping)
+        {
+            // a dense id map has an entry for every local reference up to the largest one, a
+            // sparse one stores both ids of each pair, so it is smaller for sparse references
+            std::size_t size = mapping.back().first + std::size_t(1);
+
+            if (size <= 2 * mapping.size())
+            {
+                std::vector<std::uint32_t> dense(size, OTF2_UNDEFINED_UINT32);
+
+                for (const auto& entry : mapping)
+                {
+                    dense[entry.first] = entry.second;
+                }
+
+                return otf2::definition::mapping_table(type, dense);
+            }
+
+            otf2::definition::mapping_table table(type, OTF2_ID_MAP_SPARSE, mapping.size());
+
+            for (const auto& entry : mapping)
+            {
+                table.add(entry.first, entry.second);
+            }
+
+            return table;
+        }
+
+    private:
+        MPI_Comm comm_;
+
+        mapping_type string_mapping_;
+        mapping_type region_mapping_;
+
+        // the unified definitions as keys, only on rank 0
+        std::vector<std::string> strings_;
+        std::vector<std::string> regions_;
+    };
+} // namespace writer
+} // namespace otf2
+
+#endif // OTF2XX_HAS_MPI
+
+#endif // INCLUDE_OTF2XX_WRITER_UNIFICATION_HPP
@@ -187,6 +187,7 @@ namespace reader
                             static_cast<otf2::common::paradigm_type>(paradigm),
                             static_cast<otf2::common::group_flag_type>(groupFlags));
 
+                        lsg.reserve(numberOfMembers);
                         for (std::uint32_t i = 0; i < numberOfMembers; ++i)
                         {
                             lsg.add_member(registry.get<otf2::definition::location>(members[i]));
@@ -203,6 +204,7 @@ namespace reader
                             static_cast<otf2::common::paradigm_type>(paradigm),
                             static_cast<otf2::common::group_flag_type>(groupFlags));
 
+                        rg.reserve(numberOfMembers);
                         for (std::uint32_t i = 0; i < numberOfMembers; ++i)
                         {
                             rg.add_member(registry.get<otf2::definition::region>(members[i]));
@@ -248,6 +250,8 @@ namespace reader
                                 assert(!found);
                                 found = true;
 
+                                cg.reserve(numberOfMembers);
+
                                 for (std::uint32_t i = 0; i < numberOfMembers; ++i)
                                 {
                                     cg.add_member(group[members[i]]);
@@ -269,6 +273,7 @@ namespace reader
                             static_cast<otf2::common::paradigm_type>(paradigm),
                             static_cast<otf2::common::group_flag_type>(groupFlags));
 
+                        clg.reserve(numberOfMembers);
                         for (std::uint32_t i = 0; i < numberOfMembers; ++i)
                         {
                             clg.add_member(registry.get<otf2::definition::location>(members[i]));
@@ -67,8 +67,8 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::buffer_flush(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
-                        reader->clock_convert()(otf2::chrono::ticks(stopTime))));
+                        attributeList, reader->convert_time(locationID, time),
+                        reader->convert_time(locationID, stopTime)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
             }
@@ -83,7 +83,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::enter(attributeList,
-                                       reader->clock_convert()(otf2::chrono::ticks(time)),
+                                       reader->convert_time(locationID, time),
                                        registry.get<otf2::definition::region>(regionID)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -99,7 +99,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::leave(attributeList,
-                                       reader->clock_convert()(otf2::chrono::ticks(time)),
+                                       reader->convert_time(locationID, time),
                                        registry.get<otf2::definition::region>(regionID)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -115,7 +115,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::measurement(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         static_cast<otf2::event::measurement::mode_type>(measurementMode)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -135,8 +135,7 @@ namespace reader
                     return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
                 }
 
-                otf2::chrono::time_point timestamp =
-                    reader->clock_convert()(otf2::chrono::ticks(time));
+                otf2::chrono::time_point timestamp = reader->convert_time(locationID, time);
 
                 otf2::event::metric::values metric_values{
                     std::vector<OTF2_Type>{ typeIDs, typeIDs + numberOfMetrics },
@@ -165,7 +164,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::mpi_collective_begin(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time))));
+                        attributeList, reader->convert_time(locationID, time)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
             }
@@ -182,7 +181,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::mpi_collective_end(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         static_cast<otf2::event::mpi_collective_end::collective_type>(collectiveOp),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(communicator),
@@ -202,7 +201,7 @@ namespace reader
                 reader->callback().event(registry.get<otf2::definition::location>(locationID),
                                          otf2::event::non_blocking_collective_request(
                                              attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              requestID));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -220,7 +219,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::non_blocking_collective_complete(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         static_cast<otf2::event::mpi_collective_end::collective_type>(collectiveOp),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(communicator),
@@ -240,7 +239,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::mpi_ireceive(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)), sender,
+                        attributeList, reader->convert_time(locationID, time), sender,
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(communicator),
                         msgTag, msgLength, requestID));
@@ -258,7 +257,7 @@ namespace reader
                 reader->callback().event(registry.get<otf2::definition::location>(locationID),
                                          otf2::event::mpi_ireceive_request(
                                              attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              requestID));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -275,7 +274,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::mpi_isend(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)), receiver,
+                        attributeList, reader->convert_time(locationID, time), receiver,
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(communicator),
                         msgTag, msgLength, requestID));
@@ -293,7 +292,7 @@ namespace reader
                 reader->callback().event(registry.get<otf2::definition::location>(locationID),
                                          otf2::event::mpi_isend_complete(
                                              attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              requestID));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -310,7 +309,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::mpi_receive(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)), sender,
+                        attributeList, reader->convert_time(locationID, time), sender,
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(communicator),
                         msgTag, msgLength));
@@ -329,7 +328,7 @@ namespace reader
                 reader->callback().event(registry.get<otf2::definition::location>(locationID),
                                          otf2::event::mpi_request_cancelled(
                                              attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              requestID));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -345,7 +344,7 @@ namespace reader
                 reader->callback().event(registry.get<otf2::definition::location>(locationID),
                                          otf2::event::mpi_request_test(
                                              attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              requestID));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -362,7 +361,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::mpi_send(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)), receiver,
+                        attributeList, reader->convert_time(locationID, time), receiver,
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(communicator),
                         msgTag, msgLength));
@@ -380,7 +379,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::parameter_int(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::parameter>(parameter), value));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -396,7 +395,7 @@ namespace reader
                 reader->callback().event(registry.get<otf2::definition::location>(locationID),
                                          otf2::event::parameter_string(
                                              attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              registry.get<otf2::definition::parameter>(parameter),
                                              registry.get<otf2::definition::string>(string)));
 
@@ -414,7 +413,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::parameter_unsigned_int(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::parameter>(parameter), value));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -432,7 +431,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::calling_context_enter(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::calling_context>(callingContext),
                         unwindDistance));
 
@@ -450,7 +449,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::calling_context_leave(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::calling_context>(callingContext)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -469,7 +468,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::calling_context_sample(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::calling_context>(callingContext),
                         unwindDistance,
                         registry.get<otf2::definition::interrupt_generator>(interruptGenerator)));
@@ -488,7 +487,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_acquire_lock(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), remote, lockId,
                         static_cast<otf2::event::rma_acquire_lock::lock_type_type>(lockType)));
 
@@ -507,7 +506,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_atomic(attributeList,
-                                            reader->clock_convert()(otf2::chrono::ticks(time)),
+                                            reader->convert_time(locationID, time),
                                             registry.get<otf2::definition::rma_win>(win), remote,
                                             static_cast<otf2::event::rma_atomic::atomic_type>(type),
                                             bytesSent, bytesReceived, matchingId));
@@ -525,7 +524,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_collective_begin(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time))));
+                        attributeList, reader->convert_time(locationID, time)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
             }
@@ -543,7 +542,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_collective_end(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         static_cast<otf2::event::rma_collective_end::collective_type>(collectiveOp),
                         static_cast<otf2::event::rma_collective_end::sync_level_type>(syncLevel),
                         registry.get<otf2::definition::rma_win>(win), root, bytesSent,
@@ -563,7 +562,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_get(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), remote, bytes, matchingId));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -580,7 +579,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_group_sync(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         static_cast<otf2::event::rma_group_sync::sync_level_type>(syncLevel),
                         registry.get<otf2::definition::rma_win>(win),
                         registry.get<otf2::definition::comm_group>(group)));
@@ -599,7 +598,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_op_complete_blocking(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), matchingId));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -616,7 +615,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_op_complete_non_blocking(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), matchingId));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -633,7 +632,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_op_complete_remote(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), matchingId));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -649,7 +648,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_op_test(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), matchingId));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -666,7 +665,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_put(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), remote, bytes, matchingId));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -682,7 +681,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_release_lock(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), remote, lockId));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -699,7 +698,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_request_lock(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), remote, lockId,
                         static_cast<otf2::event::rma_request_lock::lock_type_type>(lockType)));
 
@@ -717,7 +716,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_sync(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), remote,
                         static_cast<otf2::event::rma_sync::sync_type_type>(syncType)));
 
@@ -735,7 +734,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_try_lock(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::rma_win>(win), remote, lockId,
                         static_cast<otf2::event::rma_try_lock::lock_type_type>(lockType)));
 
@@ -752,7 +751,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_wait_change(attributeList,
-                                                 reader->clock_convert()(otf2::chrono::ticks(time)),
+                                                 reader->convert_time(locationID, time),
                                                  registry.get<otf2::definition::rma_win>(win)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -768,7 +767,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_win_create(attributeList,
-                                                reader->clock_convert()(otf2::chrono::ticks(time)),
+                                                reader->convert_time(locationID, time),
                                                 registry.get<otf2::definition::rma_win>(win)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -784,7 +783,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::rma_win_destroy(attributeList,
-                                                 reader->clock_convert()(otf2::chrono::ticks(time)),
+                                                 reader->convert_time(locationID, time),
                                                  registry.get<otf2::definition::rma_win>(win)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -801,7 +800,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_acquire_lock(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         static_cast<otf2::common::paradigm_type>(model), lockID, acquisitionOrder));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -817,7 +816,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_fork(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         static_cast<otf2::common::paradigm_type>(model), numberOfRequestedThreads));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -833,7 +832,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_join(attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              static_cast<otf2::common::paradigm_type>(model)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -850,7 +849,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_release_lock(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         static_cast<otf2::common::paradigm_type>(model), lockID, acquisitionOrder));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -868,7 +867,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_task_complete(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(threadTeam),
                         creatingThread, generationNumber));
@@ -887,7 +886,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_task_create(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(threadTeam),
                         creatingThread, generationNumber));
@@ -906,7 +905,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_task_switch(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(threadTeam),
                         creatingThread, generationNumber));
@@ -924,7 +923,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_team_begin(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(threadTeam)));
 
@@ -941,7 +940,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_team_end(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(threadTeam)));
 
@@ -959,7 +958,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_create(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(threadContingent),
                         sequenceCount));
@@ -978,7 +977,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_begin(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(threadContingent),
                         sequenceCount));
@@ -997,7 +996,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_wait(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(threadContingent),
                         sequenceCount));
@@ -1015,7 +1014,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::thread_end(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(threadContingent),
                         sequenceCount));
@@ -1035,7 +1034,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_create_handle(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::io_handle>(handle),
                         static_cast<otf2::common::io_access_mode_type>(mode),
                         static_cast<otf2::common::io_creation_flag_type>(creationFlags),
@@ -1054,7 +1053,7 @@ namespace reader
                 reader->callback().event(registry.get<otf2::definition::location>(locationID),
                                          otf2::event::io_destroy_handle(
                                              attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              registry.get<otf2::definition::io_handle>(handle)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -1072,7 +1071,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_duplicate_handle(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::io_handle>(oldHandle),
                         registry.get<otf2::definition::io_handle>(newHandle),
                         static_cast<otf2::common::io_status_flag_type>(statusFlags)));
@@ -1091,7 +1090,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_seek(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::io_handle>(handle), offsetRequest,
                         static_cast<otf2::common::io_seek_option_type>(whence), offsetResult));
 
@@ -1110,7 +1109,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_change_status_flag(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::io_handle>(handle),
                         static_cast<otf2::common::io_status_flag_type>(statusFlags)));
 
@@ -1129,7 +1128,7 @@ namespace reader
                     reader->callback().event(
                         registry.get<otf2::definition::location>(locationID),
                         otf2::event::io_delete_file(
-                            attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                            attributeList, reader->convert_time(locationID, time),
                             registry.get<otf2::definition::io_paradigm>(ioParadigm),
                             registry.get<otf2::definition::io_regular_file>(file)));
                 }
@@ -1138,7 +1137,7 @@ namespace reader
                     reader->callback().event(
                         registry.get<otf2::definition::location>(locationID),
                         otf2::event::io_delete_file(
-                            attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                            attributeList, reader->convert_time(locationID, time),
                             registry.get<otf2::definition::io_paradigm>(ioParadigm),
                             registry.get<otf2::definition::io_directory>(file)));
                 }
@@ -1158,7 +1157,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_operation_begin(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::io_handle>(handle),
                         static_cast<otf2::common::io_operation_mode_type>(mode),
                         static_cast<otf2::common::io_operation_flag_type>(operationFlags),
@@ -1177,7 +1176,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_operation_test(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::io_handle>(handle), matchingId));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -1193,7 +1192,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_operation_issued(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::io_handle>(handle), matchingId));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -1210,7 +1209,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_operation_cancelled(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::io_handle>(handle), matchingId));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -1228,7 +1227,7 @@ namespace reader
                 reader->callback().event(registry.get<otf2::definition::location>(locationID),
                                          otf2::event::io_operation_complete(
                                              attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              registry.get<otf2::definition::io_handle>(handle),
                                              bytesRequest, matchingId));
 
@@ -1245,7 +1244,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_acquire_lock(attributeList,
-                                                 reader->clock_convert()(otf2::chrono::ticks(time)),
+                                                 reader->convert_time(locationID, time),
                                                  registry.get<otf2::definition::io_handle>(handle),
                                                  static_cast<otf2::common::lock_type>(lockType)));
 
@@ -1262,7 +1261,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_release_lock(attributeList,
-                                                 reader->clock_convert()(otf2::chrono::ticks(time)),
+                                                 reader->convert_time(locationID, time),
                                                  registry.get<otf2::definition::io_handle>(handle),
                                                  static_cast<otf2::common::lock_type>(lockType)));
 
@@ -1279,7 +1278,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::io_try_lock(attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              registry.get<otf2::definition::io_handle>(handle),
                                              static_cast<otf2::common::lock_type>(lockType)));
 
@@ -1304,7 +1303,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::program_begin(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(locationID, time),
                         registry.get<otf2::definition::string>(programName), args));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -1320,7 +1319,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
                     otf2::event::program_end(attributeList,
-                                             reader->clock_convert()(otf2::chrono::ticks(time)),
+                                             reader->convert_time(locationID, time),
                                              exitStatus));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
@@ -1336,7 +1335,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(location),
                     otf2::event::comm_create(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(location, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(communicator)));
 
@@ -1353,7 +1352,7 @@ namespace reader
                 reader->callback().event(
                     registry.get<otf2::definition::location>(location),
                     otf2::event::comm_destroy(
-                        attributeList, reader->clock_convert()(otf2::chrono::ticks(time)),
+                        attributeList, reader->convert_time(location, time),
                         registry.get_variant_weak<otf2::definition::comm,
                                                   otf2::definition::inter_comm>(communicator)));
 
@@ -1368,7 +1367,7 @@ namespace reader
 
                 reader->callback().event(
                     registry.get<otf2::definition::location>(locationID),
-                    otf2::event::unknown(reader->clock_convert()(otf2::chrono::ticks(time))));
+                    otf2::event::unknown(reader->convert_time(locationID, time)));
 
                 return static_cast<OTF2_CallbackCode>(OTF2_SUCCESS);
             }
@@ -0,0 +1,186 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2017, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/async.hpp>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    const int num_threads = 4;
+    const int num_events = 100000;
+
+    otf2::writer::archive ar("otf2xx_async_writer_trace", "traces");
+
+    auto& reg = ar.registry();
+
+    auto& root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("host"), reg.create<otf2::definition::string>("node"));
+
+    auto& lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Master Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto& name = reg.create<otf2::definition::string>("function");
+    auto& region = reg.create<otf2::definition::region>(
+        name, name, name, otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        name, 0, 0);
+
+    std::vector<otf2::definition::location> locations;
+    for (int i = 0; i < num_threads; i++)
+    {
+        locations.push_back(reg.create<otf2::definition::location>(
+            reg.create<otf2::definition::string>("Thread " + std::to_string(i)), lg,
+            otf2::definition::location::location_type::cpu_thread));
+    }
+
+    std::vector<otf2::definition::location> dropping_locations;
+    for (int i = 0; i < num_threads; i++)
+    {
+        dropping_locations.push_back(reg.create<otf2::definition::location>(
+            reg.create<otf2::definition::string>("Dropping Thread " + std::to_string(i)), lg,
+            otf2::definition::location::location_type::cpu_thread));
+    }
+
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(4 * num_events));
+
+    {
+        // queues smaller than the number of events test the blocking back pressure
+        otf2::writer::async async(otf2::writer::back_pressure::block, 1024);
+
+        std::vector<std::thread> threads;
+        for (const auto& location : locations)
+        {
+            auto& queue = async.attach(ar(location));
+
+            threads.emplace_back(
+                [&queue, &region]()
+                {
+                    for (int i = 0; i < num_events; i++)
+                    {
+                        otf2::chrono::time_point timestamp(otf2::chrono::duration(2 * i));
+
+                        queue << otf2::event::enter(timestamp, region);
+                        queue << otf2::event::leave(timestamp + otf2::chrono::duration(1), region);
+                    }
+
+                    // other events are stored as a whole
+                    otf2::chrono::time_point end(otf2::chrono::duration(2 * num_events));
+                    queue << otf2::event::buffer_flush(end, end);
+                });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        async.flush();
+
+        if (async.dropped() != 0)
+        {
+            std::cerr << "Dropped " << async.dropped() << " events" << std::endl;
+            return 1;
+        }
+    }
+
+    for (const auto& location : locations)
+    {
+        if (ar(location).num_events() != 2 * num_events + 1)
+        {
+            std::cerr << "Missing events on location #" << location.ref() << std::endl;
+            return 1;
+        }
+    }
+
+    std::uint64_t dropped;
+    {
+        // tiny queues make the drop policy drop, but only whole calls
+        otf2::writer::async async(otf2::writer::back_pressure::drop, 4);
+
+        std::vector<std::thread> threads;
+        for (const auto& location : dropping_locations)
+        {
+            auto& queue = async.attach(ar(location));
+
+            threads.emplace_back(
+                [&queue, &region]()
+                {
+                    for (int i = 0; i < num_events; i++)
+                    {
+                        otf2::chrono::time_point timestamp(otf2::chrono::duration(4 * i));
+
+                        queue << otf2::event::enter(timestamp, region);
+                        queue << otf2::event::enter(timestamp + otf2::chrono::duration(1), region);
+                        queue << otf2::event::leave(timestamp + otf2::chrono::duration(2), region);
+                        queue << otf2::event::leave(timestamp + otf2::chrono::duration(3), region);
+                    }
+                });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        dropped = async.dropped();
+    }
+
+    std::uint64_t written = 0;
+    for (const auto& location : dropping_locations)
+    {
+        // a leave is never dropped without its enter
+        if (ar(location).num_events() % 2 != 0)
+        {
+            std::cerr << "Unbalanced calls on location #" << location.ref() << std::endl;
+            return 1;
+        }
+
+        written += ar(location).num_events();
+    }
+
+    if (written + dropped != 4ull * num_events * num_threads)
+    {
+        std::cerr << "Lost " << 4ull * num_events * num_threads - written - dropped << " events"
+                  << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,160 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+class event_counter : public otf2::reader::callback
+{
+public:
+    explicit event_counter(otf2::reader::reader& rdr) : rdr_(rdr)
+    {
+    }
+
+    void definition(const otf2::definition::location& loc) override
+    {
+        rdr_.register_location(loc);
+        events = loc.num_events();
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::enter&) override
+    {
+        enters++;
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::leave&) override
+    {
+        leaves++;
+    }
+
+    std::uint64_t events = 0;
+    std::uint64_t enters = 0;
+    std::uint64_t leaves = 0;
+
+private:
+    otf2::reader::reader& rdr_;
+};
+
+bool write_trace()
+{
+    otf2::writer::archive ar("otf2xx_batch_write_trace", "traces");
+
+    auto& reg = ar().registry();
+
+    auto root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("MyHost"),
+        reg.create<otf2::definition::string>("node"));
+
+    auto lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Master Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto location = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("MainThread"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto empty = reg.create<otf2::definition::string>("");
+    auto region = reg.create<otf2::definition::region>(
+        reg.create<otf2::definition::string>("MyFunction"), empty, empty,
+        otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        empty, 0, 0);
+
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(40));
+
+    auto& arl = ar(location);
+
+    std::vector<otf2::chrono::time_point> timestamps;
+    std::vector<OTF2_RegionRef> regions(10, region.ref());
+
+    for (int i = 0; i < 10; ++i)
+        timestamps.emplace_back(std::chrono::nanoseconds(i));
+    arl.write_enters(timestamps.data(), regions.data(), timestamps.size());
+
+    timestamps.clear();
+    for (int i = 10; i < 20; ++i)
+        timestamps.emplace_back(std::chrono::nanoseconds(i));
+    arl.write_leaves(timestamps.data(), regions.data(), timestamps.size());
+
+    if (arl.num_events() != 20)
+    {
+        std::cerr << "Counted " << arl.num_events() << " events of the enter and leave runs"
+                  << std::endl;
+        return false;
+    }
+
+    std::vector<otf2::event::enter> enters;
+    for (int i = 20; i < 30; ++i)
+        enters.emplace_back(otf2::chrono::time_point(std::chrono::nanoseconds(i)), region);
+    arl.write(enters.data(), enters.size());
+
+    std::vector<otf2::event::leave> leaves;
+    for (int i = 30; i < 40; ++i)
+        leaves.emplace_back(otf2::chrono::time_point(std::chrono::nanoseconds(i)), region);
+    arl.write(leaves.data(), leaves.size());
+
+    if (arl.num_events() != 40)
+    {
+        std::cerr << "Counted " << arl.num_events() << " events after the event arrays"
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    if (!write_trace())
+    {
+        return 1;
+    }
+
+    otf2::reader::reader rdr("otf2xx_batch_write_trace/traces.otf2");
+    event_counter counter(rdr);
+    rdr.set_callback(counter);
+    rdr.read_definitions();
+    rdr.read_events();
+
+    if (counter.events != 40 || counter.enters != 20 || counter.leaves != 20)
+    {
+        std::cerr << "Read " << counter.events << " events, " << counter.enters << " enters and "
+                  << counter.leaves << " leaves" << std::endl;
+        return 1;
+    }
+}
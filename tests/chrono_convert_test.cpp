@@ -38,6 +38,7 @@
 #include <otf2xx/otf2.hpp>
 
 #include <map>
+#include <vector>
 
 auto tp = [](auto ticks) { return otf2::chrono::time_point(otf2::chrono::duration(ticks)); };
 
@@ -70,12 +71,12 @@ TEST_CASE("chrono conversions work")
 
             THEN("the intermediate is what one would expect")
             {
-                REQUIRE(res.count() == otf2::chrono::ticks(1043).count());
+                REQUIRE(res.count() == otf2::chrono::ticks(1042).count());
             }
 
-            THEN("it stays null")
+            THEN("it stays the same")
             {
-                REQUIRE(c(res) == tp(1'001'000'000'000));
+                REQUIRE(c(res) == tp(1'000'000'000'000));
             }
         }
 
@@ -88,9 +89,57 @@ TEST_CASE("chrono conversions work")
                 REQUIRE(res == tp(1'000'000'000'000));
             }
 
-            THEN("it stays null")
+            THEN("it stays the same")
+            {
+                REQUIRE(c(res).count() == otf2::chrono::ticks(1042).count());
+            }
+        }
+    }
+
+    GIVEN("a converter with a resolution finer than the clock")
+    {
+        otf2::chrono::convert c(otf2::chrono::ticks(4 * std::pico::den), otf2::chrono::ticks(7));
+
+        WHEN("converting a tick back and forth")
+        {
+            auto res = c(otf2::chrono::ticks(4 * 1'000'000'000'003 + 2 + 7));
+
+            THEN("the fraction of a clock period is cut off")
+            {
+                REQUIRE(res == tp(1'000'000'000'003));
+            }
+
+            THEN("it is exact for whole clock periods")
             {
-                REQUIRE(c(res).count() == otf2::chrono::ticks(1043).count());
+                REQUIRE(c(res).count() == otf2::chrono::ticks(4 * 1'000'000'000'003 + 7).count());
+            }
+        }
+    }
+
+    GIVEN("a converter with an odd number of clock periods per tick")
+    {
+        otf2::chrono::convert c(otf2::chrono::ticks(std::pico::den / 3'125));
+
+        WHEN("converting a large number of ticks back and forth")
+        {
+            auto res = c(otf2::chrono::ticks(2'000'000'000'001));
+
+            THEN("the intermediate is exact")
+            {
+                REQUIRE(res == tp(2'000'000'000'001 * 3'125));
+            }
+
+            THEN("it stays the same")
+            {
+                REQUIRE(c(res).count() == otf2::chrono::ticks(2'000'000'000'001).count());
+            }
+        }
+
+        WHEN("converting a time point between two ticks")
+        {
+            THEN("it is rounded up to the next tick")
+            {
+                REQUIRE(c(tp(3'125 * 5 + 1)).count() == otf2::chrono::ticks(6).count());
             }
         }
     }
@@ -163,18 +212,15 @@ TEST_CASE("chrono conversions work")
         {
             auto res = c(otf2::chrono::ticks(std::numeric_limits<std::int64_t>::max() - 1));
 
-            THEN("the intermediate is what one would expect")
+            THEN("the intermediate is exact")
             {
-                REQUIRE(res == tp(std::numeric_limits<std::int64_t>::max() - OFFSET.count() + 1));
+                REQUIRE(res == tp(std::numeric_limits<std::int64_t>::max() - 1 - OFFSET.count()));
             }
 
-            THEN("it stays the same, sort of")
+            THEN("it stays the same")
             {
-                REQUIRE(
-                    c(res).count() ==
-                    otf2::chrono::ticks(
-                        static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) + 1)
-                        .count());
+                REQUIRE(c(res).count() ==
+                        otf2::chrono::ticks(std::numeric_limits<std::int64_t>::max() - 1).count());
             }
         }
 
@@ -182,18 +228,15 @@ TEST_CASE("chrono conversions work")
         {
             auto res = c(otf2::chrono::ticks(std::numeric_limits<std::int64_t>::max()));
 
-            THEN("the intermediate is what one would expect")
+            THEN("the intermediate is exact")
             {
-                REQUIRE(res == tp(std::numeric_limits<std::int64_t>::max() - OFFSET.count() + 1));
+                REQUIRE(res == tp(std::numeric_limits<std::int64_t>::max() - OFFSET.count()));
             }
 
-            THEN("it stays the same, sort of")
+            THEN("it stays the same")
             {
-                REQUIRE(
-                    c(res).count() ==
-                    otf2::chrono::ticks(
-                        static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) + 1)
-                        .count());
+                REQUIRE(c(res).count() ==
+                        otf2::chrono::ticks(std::numeric_limits<std::int64_t>::max()).count());
             }
         }
     }
@@ -248,3 +291,113 @@ TEST_CASE("chrono conversions work")
         }
     }
 }
+
+TEST_CASE("chrono converter with zero ticks per second")
+{
+    // doesn't convert anything sensible, but must not divide by zero on construction
+    REQUIRE_NOTHROW(otf2::chrono::convert{ otf2::chrono::ticks(0) });
+}
+
+TEST_CASE("batch chrono conversions match single conversions")
+{
+    std::vector<otf2::chrono::ticks> ticks_per_second = {
+        otf2::chrono::ticks(std::pico::den), otf2::chrono::ticks(1'000'000'000),
+        otf2::chrono::ticks(4 * std::pico::den), otf2::chrono::ticks(2'600'000'000)
+    };
+
+    for (auto tps : ticks_per_second)
+    {
+        otf2::chrono::convert c(tps, otf2::chrono::ticks(17));
+
+        std::vector<otf2::chrono::ticks> ticks;
+        for (std::uint64_t i = 0; i < 1000; ++i)
+            ticks.emplace_back(17 + i * 1'234'567 + i % 7);
+
+        std::vector<otf2::chrono::time_point> time_points(ticks.size());
+        c(ticks.data(), time_points.data(), ticks.size());
+
+        std::vector<otf2::chrono::ticks> round_trip(ticks.size(), otf2::chrono::ticks(0));
+        c(time_points.data(), round_trip.data(), time_points.size());
+
+        for (std::size_t i = 0; i < ticks.size(); ++i)
+        {
+            REQUIRE(time_points[i] == c(ticks[i]));
+            REQUIRE(round_trip[i].count() == c(time_points[i]).count());
+        }
+    }
+}
+
+TEST_CASE("clock corrections")
+{
+    using otf2::chrono::ticks;
+
+    GIVEN("no correction")
+    {
+        otf2::chrono::clock_correction c;
+
+        THEN("ticks stay the same")
+        {
+            REQUIRE(c.empty());
+            REQUIRE(c(ticks(12345)).count() == 12345);
+        }
+    }
+
+    GIVEN("a linear correction with offset and drift")
+    {
+        auto c = otf2::chrono::clock_correction::linear(-100, 0.001, ticks(10'000));
+
+        THEN("the offset applies at the reference")
+        {
+            REQUIRE(c(ticks(10'000)).count() == 9'900);
+        }
+
+        THEN("the drift applies with distance to the reference")
+        {
+            REQUIRE(c(ticks(110'000)).count() == 110'000 - 100 + 100);
+            REQUIRE(c(ticks(20'000)).count() == 19'910);
+        }
+
+        THEN("ticks moved before the epoch are rejected")
+        {
+            REQUIRE_THROWS_AS(c(ticks(50)), otf2::exception);
+        }
+    }
+
+    GIVEN("a piecewise linear correction from synchronization points")
+    {
+        otf2::chrono::clock_correction c;
+        c.add_sync_point(ticks(1'000), ticks(1'500));
+        c.add_sync_point(ticks(2'000), ticks(2'300));
+        c.add_sync_point(ticks(4'000), ticks(4'300));
+
+        THEN("the synchronization points map exactly")
+        {
+            REQUIRE(c(ticks(1'000)).count() == 1'500);
+            REQUIRE(c(ticks(2'000)).count() == 2'300);
+            REQUIRE(c(ticks(4'000)).count() == 4'300);
+        }
+
+        THEN("the offset is interpolated between them")
+        {
+            REQUIRE(c(ticks(1'500)).count() == 1'500 + 400);
+            REQUIRE(c(ticks(3'000)).count() == 3'300);
+        }
+
+        THEN("the outer segments are extrapolated")
+        {
+            REQUIRE(c(ticks(500)).count() == 500 + 600);
+            REQUIRE(c(ticks(5'000)).count() == 5'300);
+        }
+
+        THEN("going back in time works as well")
+        {
+            REQUIRE(c(ticks(3'000)).count() == 3'300);
+            REQUIRE(c(ticks(1'500)).count() == 1'900);
+        }
+
+        THEN("synchronization points out of order are rejected")
+        {
+            REQUIRE_THROWS(c.add_sync_point(ticks(3'000), ticks(3'000)));
+        }
+    }
+}
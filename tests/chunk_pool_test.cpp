@@ -0,0 +1,201 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/chunk_pool.hpp>
+#include <otf2xx/writer/flush_policy.hpp>
+
+#include <atomic>
+#include <set>
+#include <string>
+
+TEST_CASE("Chunk pool hands out preallocated chunks")
+{
+    otf2::writer::chunk_pool pool(1024, 4);
+
+    auto callbacks = otf2::writer::chunk_pool::callbacks();
+
+    void* buffer_a = nullptr;
+    void* buffer_b = nullptr;
+
+    auto allocate = [&](void** buffer, std::uint64_t size)
+    { return callbacks->otf2_allocate(&pool, OTF2_FILETYPE_EVENTS, 0, buffer, size); };
+
+    REQUIRE(pool.available() == 4);
+
+    SECTION("chunks are distinct until the pool is exhausted")
+    {
+        std::set<void*> chunks;
+        chunks.insert(allocate(&buffer_a, 1024));
+        chunks.insert(allocate(&buffer_b, 1024));
+        chunks.insert(allocate(&buffer_a, 512));
+        chunks.insert(allocate(&buffer_b, 1024));
+
+        REQUIRE(chunks.size() == 4);
+        REQUIRE(chunks.count(nullptr) == 0);
+        REQUIRE(pool.available() == 0);
+
+        REQUIRE(allocate(&buffer_a, 1024) == nullptr);
+
+        SECTION("freeing a buffer returns only its chunks")
+        {
+            callbacks->otf2_free_all(&pool, OTF2_FILETYPE_EVENTS, 0, &buffer_a, false);
+
+            REQUIRE(buffer_a == nullptr);
+            REQUIRE(pool.available() == 2);
+
+            auto chunk = allocate(&buffer_a, 1024);
+            REQUIRE(chunks.count(chunk) == 1);
+
+            callbacks->otf2_free_all(&pool, OTF2_FILETYPE_EVENTS, 0, &buffer_a, true);
+            callbacks->otf2_free_all(&pool, OTF2_FILETYPE_EVENTS, 0, &buffer_b, true);
+
+            REQUIRE(pool.available() == 4);
+        }
+    }
+
+    SECTION("a buffer can't take more chunks than its limit")
+    {
+        pool.set_buffer_limit(2);
+
+        REQUIRE(allocate(&buffer_a, 1024) != nullptr);
+        REQUIRE(allocate(&buffer_a, 1024) != nullptr);
+        REQUIRE(allocate(&buffer_a, 1024) == nullptr);
+
+        REQUIRE(allocate(&buffer_b, 1024) != nullptr);
+        REQUIRE(pool.available() == 1);
+    }
+
+    SECTION("chunks larger than the pool's chunks are refused")
+    {
+        REQUIRE(allocate(&buffer_a, 2048) == nullptr);
+        REQUIRE(pool.available() == 4);
+    }
+}
+
+class enter_counter : public otf2::reader::callback
+{
+public:
+    explicit enter_counter(otf2::reader::reader& rdr) : rdr_(rdr)
+    {
+    }
+
+    void definition(const otf2::definition::location& loc) override
+    {
+        rdr_.register_location(loc);
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::enter&) override
+    {
+        enters++;
+    }
+
+    std::uint64_t enters = 0;
+
+private:
+    otf2::reader::reader& rdr_;
+};
+
+TEST_CASE("Archive takes its buffer chunks from the pool")
+{
+    const std::size_t chunk_size = 256 * 1024;
+    const int events = 100000;
+
+    otf2::writer::chunk_pool pool(chunk_size, 16);
+    pool.set_buffer_limit(2);
+
+    std::atomic<std::int64_t> clock{ 0 };
+    otf2::writer::flush_policy policy(
+        [&clock]() { return otf2::chrono::time_point(otf2::chrono::duration(++clock)); });
+
+    {
+        otf2::writer::archive ar("otf2xx_chunk_pool_trace", "traces", OTF2_FILEMODE_WRITE,
+                                 chunk_size, chunk_size);
+        ar.set_memory_callbacks(pool);
+        ar.set_flush_policy(policy);
+
+        auto& reg = ar.registry();
+
+        auto& root_node = reg.create<otf2::definition::system_tree_node>(
+            reg.create<otf2::definition::string>("host"),
+            reg.create<otf2::definition::string>("node"));
+
+        auto& lg = reg.create<otf2::definition::location_group>(
+            reg.create<otf2::definition::string>("Master Process"),
+            otf2::definition::location_group::location_group_type::process, root_node);
+
+        auto& name = reg.create<otf2::definition::string>("function");
+        auto& region = reg.create<otf2::definition::region>(
+            name, name, name, otf2::definition::region::role_type::function,
+            otf2::definition::region::paradigm_type::user,
+            otf2::definition::region::flags_type::none, name, 0, 0);
+
+        ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                                 otf2::chrono::ticks(2 * events));
+
+        for (int i = 0; i < 2; ++i)
+        {
+            auto& location = reg.create<otf2::definition::location>(
+                reg.create<otf2::definition::string>("Thread " + std::to_string(i)), lg,
+                otf2::definition::location::location_type::cpu_thread);
+
+            // a few MB of events, far more than the two chunks a buffer may hold
+            auto& writer = ar(location);
+            for (int j = 0; j < events; ++j)
+            {
+                writer << otf2::event::enter(
+                    otf2::chrono::time_point(otf2::chrono::duration(2 * j)), region);
+                writer << otf2::event::leave(
+                    otf2::chrono::time_point(otf2::chrono::duration(2 * j + 1)), region);
+            }
+        }
+
+        // OTF2 takes no chunk beyond the limit, but flushes the buffer instead
+        REQUIRE(policy.flushes() > 0);
+    }
+
+    // every buffer returned its chunks on close
+    REQUIRE(pool.available() == pool.capacity());
+
+    otf2::reader::reader rdr("otf2xx_chunk_pool_trace/traces.otf2");
+    enter_counter counter(rdr);
+    rdr.set_callback(counter);
+    rdr.read_definitions();
+    rdr.read_events();
+
+    REQUIRE(counter.enters == 2 * events);
+}
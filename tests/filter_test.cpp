@@ -0,0 +1,135 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/filter.hpp>
+
+#include <iostream>
+
+int main()
+{
+    const int num_calls = 100;
+
+    otf2::writer::archive ar("otf2xx_filter_trace", "traces");
+
+    auto& reg = ar.registry();
+
+    auto& root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("host"), reg.create<otf2::definition::string>("node"));
+
+    auto& lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Master Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto& location = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("Main Thread"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto make_region = [&reg](const char* str) -> const otf2::definition::region& {
+        auto& name = reg.create<otf2::definition::string>(str);
+        return reg.create<otf2::definition::region>(
+            name, name, name, otf2::definition::region::role_type::function,
+            otf2::definition::region::paradigm_type::user,
+            otf2::definition::region::flags_type::none, name, 0, 0);
+    };
+
+    auto& outer = make_region("outer");
+    auto& inner = make_region("inner");
+    auto& excluded = make_region("excluded");
+    auto& wrapper = make_region("wrapper");
+
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(20 * num_calls));
+
+    otf2::writer::filter rules;
+    rules.exclude(excluded).min_duration(otf2::chrono::duration(5));
+
+    std::uint64_t dropped = 0;
+    {
+        otf2::writer::filtered_local writer(ar(location), rules);
+
+        for (int i = 0; i < num_calls; i++)
+        {
+            otf2::chrono::time_point timestamp(otf2::chrono::duration(20 * i));
+            auto at = [timestamp](int offset) {
+                return timestamp + otf2::chrono::duration(offset);
+            };
+
+            // the inner call is too short, the excluded one is dropped regardless of its
+            // duration, so only the outer call remains
+            writer << otf2::event::enter(at(0), outer);
+            writer << otf2::event::enter(at(1), inner);
+            writer << otf2::event::leave(at(2), inner);
+            writer << otf2::event::enter(at(2), excluded);
+            writer << otf2::event::leave(at(8), excluded);
+            writer << otf2::event::leave(at(9), outer);
+
+            // the wrapper is too short and only has too short calls nested, so it is dropped
+            // with all of them
+            writer << otf2::event::enter(at(10), wrapper);
+            writer << otf2::event::enter(at(11), inner);
+            writer << otf2::event::leave(at(12), inner);
+            writer << otf2::event::enter(at(12), inner);
+            writer << otf2::event::leave(at(13), inner);
+            writer << otf2::event::leave(at(14), wrapper);
+        }
+
+        dropped = writer.dropped();
+    }
+
+    // the event count of the location definition is written by the archive
+    if (dropped != 10 * num_calls || location.num_events() != 2 * num_calls)
+    {
+        std::cerr << "Dropped " << dropped << " events, wrote " << location.num_events()
+                  << " events" << std::endl;
+        return 1;
+    }
+
+    // region references don't have to be dense
+    auto& name = reg.create<otf2::definition::string>("sparse");
+    auto& sparse = reg.create<otf2::definition::region>(
+        4'000'000'000u, name, name, name, otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        name, 0, 0);
+
+    otf2::writer::filter only_sparse(false);
+    only_sparse.include(sparse);
+
+    if (!only_sparse.includes(sparse.ref()) || only_sparse.includes(outer.ref()))
+    {
+        std::cerr << "The filter doesn't follow the rule of a sparse region reference"
+                  << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/flight_recorder.hpp>
+
+#include <iostream>
+
+int main()
+{
+    const int num_events = 1000;
+    const std::size_t ring_size = 100;
+
+    otf2::writer::archive ar("otf2xx_flight_recorder_trace", "traces");
+
+    auto& reg = ar.registry();
+
+    auto& root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("host"), reg.create<otf2::definition::string>("node"));
+
+    auto& lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Master Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto& location = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("Main Thread"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto& name = reg.create<otf2::definition::string>("function");
+    auto& region = reg.create<otf2::definition::region>(
+        name, name, name, otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        name, 0, 0);
+
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(2 * num_events));
+
+    otf2::writer::flight_recorder recorder(ring_size *
+                                           sizeof(otf2::writer::detail::recorder_record));
+
+    auto& ring = recorder.attach(location);
+
+    for (int i = 0; i < num_events; i++)
+    {
+        otf2::chrono::time_point timestamp(otf2::chrono::duration(2 * i));
+
+        ring << otf2::event::enter(timestamp, region);
+        ring << otf2::event::leave(timestamp + otf2::chrono::duration(1), region);
+    }
+
+    if (ring.size() != ring_size || recorder.overwritten() != 2 * num_events - ring_size)
+    {
+        std::cerr << "The ring holds " << ring.size() << " events" << std::endl;
+        return 1;
+    }
+
+    recorder.dump(ar);
+
+    // the event count of the location definition is written by the archive
+    if (ring.size() != 0 || location.num_events() != ring_size)
+    {
+        std::cerr << "Dumped " << location.num_events() << " events" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,169 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/flush_policy.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Flush policy limits concurrent flushes")
+{
+    std::atomic<std::int64_t> clock{ 0 };
+
+    otf2::writer::flush_policy policy(
+        [&clock]() { return otf2::chrono::time_point(otf2::chrono::duration(++clock)); }, 2);
+
+    std::atomic<int> running{ 0 };
+    std::atomic<int> max_running{ 0 };
+    std::atomic<int> flushes{ 0 };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back(
+            [&, i]()
+            {
+                otf2::reference<otf2::definition::location> location(i);
+
+                for (int j = 0; j < 100; ++j)
+                {
+                    // Catch assertions aren't thread-safe, so just count here
+                    if (policy.pre_flush(OTF2_FILETYPE_EVENTS, location, false) == OTF2_FLUSH)
+                    {
+                        ++flushes;
+                    }
+
+                    auto now = ++running;
+                    auto max = max_running.load();
+                    while (now > max && !max_running.compare_exchange_weak(max, now))
+                    {
+                    }
+
+                    std::this_thread::yield();
+                    --running;
+
+                    policy.post_flush(location);
+                }
+            });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(flushes == 800);
+    REQUIRE(max_running <= 2);
+    REQUIRE(policy.flushes() == 800);
+    REQUIRE(clock == 800);
+}
+
+TEST_CASE("Flush policy ignores flushes without post flush")
+{
+    std::atomic<std::int64_t> clock{ 0 };
+
+    otf2::writer::flush_policy policy(
+        [&clock]() { return otf2::chrono::time_point(otf2::chrono::duration(++clock)); }, 1);
+
+    otf2::reference<otf2::definition::location> location(0);
+
+    // OTF2 calls the post flush only for intermediate flushes of event buffers
+    for (int i = 0; i < 10; ++i)
+    {
+        REQUIRE(policy.pre_flush(OTF2_FILETYPE_LOCAL_DEFS, location, false) == OTF2_FLUSH);
+        REQUIRE(policy.pre_flush(OTF2_FILETYPE_EVENTS, location, true) == OTF2_FLUSH);
+    }
+
+    REQUIRE(policy.pre_flush(OTF2_FILETYPE_EVENTS, location, false) == OTF2_FLUSH);
+    policy.post_flush(location);
+
+    REQUIRE(policy.flushes() == 1);
+    REQUIRE(policy.delayed_flushes() == 0);
+}
+
+TEST_CASE("Archive with a flush policy closes more locations than slots")
+{
+    std::atomic<std::int64_t> clock{ 0 };
+
+    otf2::writer::flush_policy policy(
+        [&clock]() { return otf2::chrono::time_point(otf2::chrono::duration(++clock)); }, 1);
+
+    {
+        otf2::writer::archive ar("otf2xx_flush_policy_trace", "traces");
+        ar.set_flush_policy(policy);
+
+        auto& reg = ar.registry();
+
+        auto& root_node = reg.create<otf2::definition::system_tree_node>(
+            reg.create<otf2::definition::string>("host"),
+            reg.create<otf2::definition::string>("node"));
+
+        auto& lg = reg.create<otf2::definition::location_group>(
+            reg.create<otf2::definition::string>("Master Process"),
+            otf2::definition::location_group::location_group_type::process, root_node);
+
+        auto& name = reg.create<otf2::definition::string>("function");
+        auto& region = reg.create<otf2::definition::region>(
+            name, name, name, otf2::definition::region::role_type::function,
+            otf2::definition::region::paradigm_type::user,
+            otf2::definition::region::flags_type::none, name, 0, 0);
+
+        ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                                 otf2::chrono::ticks(2));
+
+        for (int i = 0; i < 4; ++i)
+        {
+            auto& location = reg.create<otf2::definition::location>(
+                reg.create<otf2::definition::string>("Thread " + std::to_string(i)), lg,
+                otf2::definition::location::location_type::cpu_thread);
+
+            auto& writer = ar(location);
+            writer << otf2::event::enter(otf2::chrono::time_point(otf2::chrono::duration(0)),
+                                         region);
+            writer << otf2::event::leave(otf2::chrono::time_point(otf2::chrono::duration(1)),
+                                         region);
+        }
+
+        // closing the archive flushes the event and definition buffers of every location
+    }
+
+    // with leaked slots, the archive wouldn't have closed
+    REQUIRE(policy.delayed_flushes() == 0);
+}
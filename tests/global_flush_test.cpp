@@ -0,0 +1,269 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <string>
+#include <utility>
+
+class flush_checker : public otf2::reader::callback
+{
+public:
+    explicit flush_checker(otf2::reader::reader& rdr) : rdr_(rdr)
+    {
+    }
+
+    void definition(const otf2::definition::clock_properties& def) override
+    {
+        ticks_per_second = def.ticks_per_second().count();
+        clock_properties++;
+    }
+
+    void definition(const otf2::definition::region&) override
+    {
+        regions++;
+    }
+
+    void definition(const otf2::definition::string& def) override
+    {
+        if (!strings.insert(def.ref().get()).second)
+        {
+            duplicate_strings++;
+        }
+    }
+
+    void definition(const otf2::definition::location& loc) override
+    {
+        rdr_.register_location(loc);
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::enter&) override
+    {
+        enters++;
+    }
+
+    std::uint64_t ticks_per_second = 0;
+    std::uint64_t clock_properties = 0;
+    std::uint64_t regions = 0;
+    std::uint64_t enters = 0;
+    std::set<std::uint64_t> strings;
+    std::uint64_t duplicate_strings = 0;
+
+private:
+    otf2::reader::reader& rdr_;
+};
+
+struct by_name
+{
+    using key_type = std::string;
+    key_type key;
+
+    explicit by_name(key_type key) : key(std::move(key))
+    {
+    }
+};
+
+template <typename Definition>
+struct keyed_holder
+{
+    using type = typename otf2::get_default_holder<Definition>::type;
+};
+
+template <>
+struct keyed_holder<otf2::definition::string>
+{
+    using type = otf2::lookup_definition_holder<otf2::definition::string, by_name>;
+};
+
+bool flush_keyed()
+{
+    otf2::writer::Archive<otf2::lookup_registry<keyed_holder, otf2::definition_arena>> ar(
+        "otf2xx_global_flush_trace/keyed", "traces");
+
+    auto& reg = ar().registry();
+    const auto& pool = reg.allocation().get<otf2::definition::string>();
+
+    for (int i = 0; i < 100; i++)
+    {
+        reg.emplace<otf2::definition::string>(by_name("Value" + std::to_string(i)),
+                                              "Value" + std::to_string(i));
+    }
+    auto ref = reg.get<otf2::definition::string>(by_name("Value42")).ref();
+
+    ar().flush();
+
+    // the lookup maps must not keep the flushed strings alive
+    if (pool.size() != 0)
+    {
+        std::cerr << pool.size() << " flushed strings are still alive" << std::endl;
+        return false;
+    }
+
+    const auto& flushed =
+        reg.emplace<otf2::definition::string>(by_name("Value42"), std::string("Value42"));
+    if (flushed.ref() != ref || flushed.is_valid() || pool.size() != 0)
+    {
+        std::cerr << "The flushed string was defined again" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool write_trace()
+{
+    otf2::writer::archive ar("otf2xx_global_flush_trace", "traces");
+
+    auto& reg = ar().registry();
+
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(4));
+
+    auto root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("MyHost"),
+        reg.create<otf2::definition::string>("node"));
+
+    auto lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Master Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto empty = reg.create<otf2::definition::string>("");
+    auto first_name = reg.create<otf2::definition::string>("First");
+    auto first = reg.create<otf2::definition::region>(
+        first_name, empty, empty, otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        empty, 0, 0);
+
+    // write the clock properties and everything defined so far right away
+    ar().flush();
+
+    if (reg.all<otf2::definition::region>().data().size() != 0 ||
+        reg.all<otf2::definition::string>().data().size() != 0)
+    {
+        std::cerr << "The flushed definitions are still in the registry" << std::endl;
+        return false;
+    }
+
+    try
+    {
+        ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e6), otf2::chrono::ticks(0),
+                                                 otf2::chrono::ticks(4));
+
+        std::cerr << "Changed the clock properties after they were flushed" << std::endl;
+        return false;
+    }
+    catch (const otf2::exception&)
+    {
+    }
+
+    // a flushed reference stays taken, so emplacing it again must not define it a second time
+    const auto& flushed =
+        reg.emplace<otf2::definition::string>(first_name.ref(), std::string("First"));
+    if (flushed.ref() != first_name.ref() || flushed.is_valid() ||
+        !reg.has<otf2::definition::string>(first_name.ref()) ||
+        reg.get<otf2::definition::string>(first_name.ref()).ref() != first_name.ref() ||
+        reg.all<otf2::definition::string>().data().size() != 0)
+    {
+        std::cerr << "The flushed string was defined again" << std::endl;
+        return false;
+    }
+
+    try
+    {
+        reg.create<otf2::definition::string>(first_name.ref(), std::string("First"));
+
+        std::cerr << "Created the flushed string again" << std::endl;
+        return false;
+    }
+    catch (const otf2::exception&)
+    {
+    }
+
+    // definitions created after the flush may refer to flushed ones
+    auto second = reg.create<otf2::definition::region>(
+        reg.create<otf2::definition::string>("Second"), empty, empty,
+        otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        empty, 0, 0);
+
+    auto location = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("MainThread"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto& arl = ar(location);
+
+    arl << otf2::event::enter(otf2::chrono::time_point(std::chrono::nanoseconds(0)), first);
+    arl << otf2::event::enter(otf2::chrono::time_point(std::chrono::nanoseconds(1)), second);
+    arl << otf2::event::leave(otf2::chrono::time_point(std::chrono::nanoseconds(2)), second);
+    arl << otf2::event::leave(otf2::chrono::time_point(std::chrono::nanoseconds(3)), first);
+
+    return true;
+}
+
+int main()
+{
+    if (!write_trace() || !flush_keyed())
+    {
+        return 1;
+    }
+
+    otf2::reader::reader rdr("otf2xx_global_flush_trace/traces.otf2");
+    flush_checker checker(rdr);
+    rdr.set_callback(checker);
+    rdr.read_definitions();
+    rdr.read_events();
+
+    if (checker.clock_properties != 1 || checker.ticks_per_second != 1000000000)
+    {
+        std::cerr << "Read " << checker.clock_properties << " clock properties with "
+                  << checker.ticks_per_second << " ticks per second" << std::endl;
+        return 1;
+    }
+
+    if (checker.duplicate_strings != 0)
+    {
+        std::cerr << "Read " << checker.duplicate_strings << " strings twice" << std::endl;
+        return 1;
+    }
+
+    if (checker.regions != 2 || checker.enters != 2)
+    {
+        std::cerr << "Read " << checker.regions << " regions and " << checker.enters
+                  << " enters" << std::endl;
+        return 1;
+    }
+}
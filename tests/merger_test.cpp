@@ -0,0 +1,278 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/merger.hpp>
+
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <string>
+#include <utility>
+
+struct input_summary
+{
+    std::uint64_t locations = 0;
+    std::uint64_t events = 0;
+    std::set<std::string> regions;
+};
+
+input_summary summarize(const std::string& path)
+{
+    otf2::reader::reader rdr(path);
+    rdr.read_definitions();
+
+    input_summary result;
+    for (const auto& location : rdr.registry().all<otf2::definition::location>())
+    {
+        result.locations++;
+        result.events += location.num_events();
+    }
+
+    for (const auto& region : rdr.registry().all<otf2::definition::region>())
+    {
+        result.regions.insert(region.name().str());
+    }
+
+    return result;
+}
+
+// records every enter and leave by its location, timestamp and region, as the references differ
+class event_recorder : public otf2::reader::callback
+{
+public:
+    explicit event_recorder(otf2::reader::reader& rdr) : rdr_(rdr)
+    {
+    }
+
+    void definition(const otf2::definition::location& loc) override
+    {
+        rdr_.register_location(loc);
+    }
+
+    void event(const otf2::definition::location& loc, const otf2::event::enter& event) override
+    {
+        record(loc, "enter", event.timestamp(), event.region());
+    }
+
+    void event(const otf2::definition::location& loc, const otf2::event::leave& event) override
+    {
+        record(loc, "leave", event.timestamp(), event.region());
+    }
+
+    void event(const otf2::definition::location& loc,
+               const otf2::event::calling_context_enter& event) override
+    {
+        record(loc, "calling_context_enter", event.timestamp(),
+               event.calling_context().region());
+    }
+
+    void event(const otf2::definition::location& loc,
+               const otf2::event::calling_context_leave& event) override
+    {
+        record(loc, "calling_context_leave", event.timestamp(),
+               event.calling_context().region());
+    }
+
+    std::multiset<std::string> events;
+
+private:
+    void record(const otf2::definition::location& loc, const char* kind,
+                otf2::chrono::time_point timestamp, const otf2::definition::region& region)
+    {
+        events.insert(loc.name().str() + " " + kind + " " +
+                      std::to_string(timestamp.time_since_epoch().count()) + " " +
+                      region.name().str());
+    }
+
+    otf2::reader::reader& rdr_;
+};
+
+std::multiset<std::string> read_events(const std::string& path)
+{
+    otf2::reader::reader rdr(path);
+    event_recorder recorder(rdr);
+    rdr.set_callback(recorder);
+    rdr.read_definitions();
+    rdr.read_events();
+
+    return std::move(recorder.events);
+}
+
+// writes a trace with a calling context without source code location, a region and an attribute
+// without the optional strings, which are all left undefined
+void write_calling_context_trace(const std::string& path)
+{
+    otf2::writer::archive ar(path, "traces");
+
+    auto& reg = ar.registry();
+
+    auto& root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("host"), reg.create<otf2::definition::string>("node"));
+
+    auto& lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Sampled Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto& location = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("Sampled Thread"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto& name = reg.create<otf2::definition::string>("sampled");
+    auto& region = reg.create<otf2::definition::region>(
+        name, name, name, otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::sampling,
+        otf2::definition::region::flags_type::none, name, 0, 0);
+
+    auto& context = reg.create<otf2::definition::calling_context>(
+        region, otf2::definition::source_code_location());
+
+    auto& bare_name = reg.create<otf2::definition::string>("bare");
+    auto& bare = reg.create<otf2::definition::region>(
+        bare_name, otf2::definition::string(), otf2::definition::string(),
+        otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        otf2::definition::string(), 0, 0);
+
+    reg.create<otf2::definition::attribute>(bare_name, otf2::definition::string(),
+                                            otf2::common::type::uint8);
+
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(2));
+
+    auto at = [](std::int64_t ns)
+    { return otf2::chrono::time_point(std::chrono::nanoseconds(ns)); };
+
+    ar(location) << otf2::event::enter(at(0), region);
+    ar(location) << otf2::event::leave(at(1), region);
+    ar(location) << otf2::event::calling_context_enter(at(1), context, 0);
+    ar(location) << otf2::event::enter(at(1), bare);
+    ar(location) << otf2::event::leave(at(2), bare);
+    ar(location) << otf2::event::calling_context_leave(at(2), context);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " path/to/first.otf2 path/to/second.otf2"
+                  << std::endl;
+
+        return 1;
+    }
+
+    const std::string third_path = "otf2xx_merger_trace/input";
+    write_calling_context_trace(third_path);
+
+    const std::string inputs[] = { argv[1], argv[2], third_path + "/traces.otf2" };
+
+    input_summary input;
+    std::multiset<std::string> input_events;
+
+    for (const auto& path : inputs)
+    {
+        auto summary = summarize(path);
+        input.locations += summary.locations;
+        input.events += summary.events;
+        input.regions.insert(summary.regions.begin(), summary.regions.end());
+
+        auto events = read_events(path);
+        input_events.insert(events.begin(), events.end());
+    }
+
+    input_summary output;
+    std::size_t regions = 0;
+    std::size_t calling_contexts = 0;
+
+    {
+        otf2::writer::archive ar("otf2xx_merger_trace", "traces");
+
+        otf2::writer::merger merger(ar);
+        for (const auto& path : inputs)
+        {
+            merger.add(path);
+        }
+        merger.run(2);
+
+        for (const auto& location : ar.registry().all<otf2::definition::location>())
+        {
+            output.locations++;
+            output.events += location.num_events();
+        }
+
+        for (const auto& region : ar.registry().all<otf2::definition::region>())
+        {
+            output.regions.insert(region.name().str());
+        }
+
+        regions = ar.registry().all<otf2::definition::region>().data().size();
+
+        for (const auto& context : ar.registry().all<otf2::definition::calling_context>())
+        {
+            if (!context.source_code_location().is_valid())
+            {
+                calling_contexts++;
+            }
+        }
+    }
+
+    if (output.locations != input.locations || output.events != input.events)
+    {
+        std::cerr << "Merged " << output.locations << " locations with " << output.events
+                  << " events" << std::endl;
+        return 1;
+    }
+
+    // regions with the same name have to be unified, as the writer tests define equal regions
+    if (output.regions != input.regions || regions != input.regions.size())
+    {
+        std::cerr << "Merged " << regions << " regions instead of " << input.regions.size()
+                  << std::endl;
+        return 1;
+    }
+
+    if (calling_contexts != 1)
+    {
+        std::cerr << "Merged " << calling_contexts
+                  << " calling contexts without source code location" << std::endl;
+        return 1;
+    }
+
+    // all inputs share the same clock, so the merged events keep their timestamps
+    if (read_events("otf2xx_merger_trace/traces.otf2") != input_events)
+    {
+        std::cerr << "The merged events differ from the ones of the inputs" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,225 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/profile.hpp>
+
+#include <iostream>
+#include <vector>
+
+struct recording_writer
+{
+    void write_enter(otf2::chrono::time_point, OTF2_RegionRef region)
+    {
+        path.push_back(region);
+    }
+
+    void write_leave(otf2::chrono::time_point, OTF2_RegionRef)
+    {
+        path.pop_back();
+    }
+
+    void write(const otf2::event::metric& metric)
+    {
+        if (metric.raw_values().size() == 3)
+        {
+            visits.push_back(metric.raw_values()[0].as_uint64());
+            inclusive.push_back(metric.raw_values()[1].as_double());
+            exclusive.push_back(metric.raw_values()[2].as_double());
+        }
+        else
+        {
+            sums.push_back(metric.raw_values()[0].as_uint64());
+        }
+    }
+
+    std::vector<OTF2_RegionRef> path;
+    std::vector<std::uint64_t> visits;
+    std::vector<double> inclusive;
+    std::vector<double> exclusive;
+    std::vector<std::uint64_t> sums;
+};
+
+// feeds events directly into a profile
+struct profiling_stream
+{
+    profiling_stream& operator<<(const otf2::event::enter& data)
+    {
+        profile.enter(data.timestamp(), data.region().ref());
+        return *this;
+    }
+
+    profiling_stream& operator<<(const otf2::event::leave& data)
+    {
+        profile.leave(data.timestamp(), data.region().ref());
+        return *this;
+    }
+
+    profiling_stream& operator<<(const otf2::event::metric& data)
+    {
+        profile.metric(data);
+        return *this;
+    }
+
+    otf2::writer::profile& profile;
+};
+
+int main()
+{
+    const int num_calls = 10;
+
+    otf2::writer::archive ar("otf2xx_profile_trace", "traces");
+
+    auto& reg = ar.registry();
+
+    auto& root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("host"), reg.create<otf2::definition::string>("node"));
+
+    auto& lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Master Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto& location = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("Main Thread"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto make_region = [&reg](const char* str) -> const otf2::definition::region& {
+        auto& name = reg.create<otf2::definition::string>(str);
+        return reg.create<otf2::definition::region>(
+            name, name, name, otf2::definition::region::role_type::function,
+            otf2::definition::region::paradigm_type::user,
+            otf2::definition::region::flags_type::none, name, 0, 0);
+    };
+
+    auto& main_region = make_region("main");
+    auto& foo = make_region("foo");
+    auto& bar = make_region("bar");
+
+    auto make_metric = [&reg](const char* str, otf2::common::metric_mode mode)
+        -> const otf2::definition::metric_class& {
+        auto& name = reg.create<otf2::definition::string>(str);
+        auto& metric = reg.create<otf2::definition::metric_class>(
+            otf2::common::metric_occurence::async, otf2::common::recorder_kind::abstract);
+        metric.add_member(reg.create<otf2::definition::metric_member>(
+            name, name, otf2::common::metric_type::other, mode, otf2::common::type::uint64,
+            otf2::common::base_type::decimal, 0, name));
+        return metric;
+    };
+
+    // the increments of the counter are summed up, the gauge keeps its latest value
+    auto& counter = make_metric("counter", otf2::common::metric_mode::relative_point);
+    auto& gauge = make_metric("gauge", otf2::common::metric_mode::absolute_point);
+
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(10 * num_calls + 1));
+
+    auto run = [&](auto& writer)
+    {
+        auto at = [](int offset)
+        { return otf2::chrono::time_point(otf2::chrono::duration(offset)); };
+
+        writer << otf2::event::enter(at(0), main_region);
+
+        for (int i = 0; i < num_calls; i++)
+        {
+            // foo takes 2, bar takes 6 of which 3 are spent in foo, main keeps 2 for itself
+            writer << otf2::event::enter(at(10 * i + 1), foo);
+
+            otf2::event::metric metric(at(10 * i + 2), counter);
+            metric.raw_values()[0] = 1;
+            writer << metric;
+
+            otf2::event::metric level(at(10 * i + 2), gauge);
+            level.raw_values()[0] = static_cast<std::uint64_t>(i);
+            writer << level;
+
+            writer << otf2::event::leave(at(10 * i + 3), foo);
+            writer << otf2::event::enter(at(10 * i + 4), bar);
+            writer << otf2::event::enter(at(10 * i + 5), foo);
+            writer << otf2::event::leave(at(10 * i + 8), foo);
+            writer << otf2::event::leave(at(10 * i + 10), bar);
+        }
+
+        writer << otf2::event::leave(at(10 * num_calls + 1), main_region);
+    };
+
+    otf2::writer::profile profile(otf2::writer::profile::make_summary(reg));
+    profiling_stream profile_stream{ profile };
+
+    run(profile_stream);
+
+    recording_writer result;
+    profile.write(result);
+
+    using seconds = std::chrono::duration<double>;
+    auto time = [](int ticks) { return seconds(otf2::chrono::duration(ticks)).count(); };
+
+    // the call paths are main, main/foo, main/bar and main/bar/foo in order of creation
+    if (profile.size() != 4 || !result.path.empty() ||
+        result.visits != std::vector<std::uint64_t>{ 1, num_calls, num_calls, num_calls } ||
+        result.inclusive != std::vector<double>{ time(10 * num_calls + 1), time(2 * num_calls),
+                                                 time(6 * num_calls), time(3 * num_calls) } ||
+        result.exclusive != std::vector<double>{ time(2 * num_calls + 1), time(2 * num_calls),
+                                                 time(3 * num_calls), time(3 * num_calls) } ||
+        result.sums != std::vector<std::uint64_t>{ num_calls, num_calls - 1 })
+    {
+        std::cerr << "The profile has " << profile.size() << " call paths" << std::endl;
+        return 1;
+    }
+
+    // the same events through a local writer in profiling mode
+    ar.enable_profiling(otf2::writer::profile::make_summary(reg));
+    run(ar(location));
+
+    // enabling it again would throw away the profile collected so far
+    try
+    {
+        ar.enable_profiling();
+
+        std::cerr << "Enabled profiling twice" << std::endl;
+        return 1;
+    }
+    catch (const otf2::exception&)
+    {
+    }
+
+    ar.close_local_writer(location);
+
+    // every call path is an enter, a summary metric and a leave, plus the counter and the gauge
+    if (location.num_events() != 3 * 4 + 2)
+    {
+        std::cerr << "Wrote " << location.num_events() << " events" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,190 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+
+#include <chrono>
+#include <iostream>
+
+class event_checker : public otf2::reader::callback
+{
+public:
+    explicit event_checker(otf2::reader::reader& rdr) : rdr_(rdr)
+    {
+    }
+
+    void definition(const otf2::definition::location& loc) override
+    {
+        rdr_.register_location(loc);
+        events = loc.num_events();
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::enter& event) override
+    {
+        check(event.timestamp());
+        enters++;
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::leave& event) override
+    {
+        check(event.timestamp());
+        leaves++;
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::parameter_int& event) override
+    {
+        check(event.timestamp());
+        parameters++;
+        wrong_values |= event.value() != -42;
+    }
+
+    void event(const otf2::definition::location&,
+               const otf2::event::parameter_unsigned_int& event) override
+    {
+        check(event.timestamp());
+        parameters++;
+        wrong_values |= event.value() != 42;
+    }
+
+    std::uint64_t events = 0;
+    std::uint64_t enters = 0;
+    std::uint64_t leaves = 0;
+    std::uint64_t parameters = 0;
+    bool wrong_timestamps = false;
+    bool wrong_values = false;
+
+private:
+    // the i-th event was written with i ticks
+    void check(otf2::chrono::time_point timestamp)
+    {
+        if (timestamp !=
+            otf2::chrono::time_point(std::chrono::nanoseconds(enters + leaves + parameters)))
+        {
+            wrong_timestamps = true;
+        }
+    }
+
+    otf2::reader::reader& rdr_;
+};
+
+bool write_trace()
+{
+    otf2::writer::archive ar("otf2xx_raw_writer_trace", "traces");
+
+    auto& reg = ar().registry();
+
+    auto root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("MyHost"),
+        reg.create<otf2::definition::string>("node"));
+
+    auto lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Master Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto location = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("MainThread"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto empty = reg.create<otf2::definition::string>("");
+    auto region = reg.create<otf2::definition::region>(
+        reg.create<otf2::definition::string>("MyFunction"), empty, empty,
+        otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        empty, 0, 0);
+
+    auto signed_parameter = reg.create<otf2::definition::parameter>(
+        reg.create<otf2::definition::string>("signed"), otf2::common::parameter_type::int64);
+    auto unsigned_parameter = reg.create<otf2::definition::parameter>(
+        reg.create<otf2::definition::string>("unsigned"), otf2::common::parameter_type::uint64);
+
+    // one tick per nanosecond
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(22));
+
+    auto& arl = ar(location);
+
+    // the raw writer takes the ticks as they are
+    auto raw = arl.raw();
+    for (OTF2_TimeStamp i = 0; i < 10; ++i)
+        raw.enter(i, region.ref());
+    for (OTF2_TimeStamp i = 10; i < 20; ++i)
+        raw.leave(i, region.ref());
+
+    // plain int values must pick the parameter event by name
+    raw.parameter_int(20, signed_parameter.ref(), -42);
+    raw.parameter_unsigned_int(21, unsigned_parameter.ref(), 42);
+
+    if (arl.num_events() != 22)
+    {
+        std::cerr << "Counted " << arl.num_events() << " raw events" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    if (!write_trace())
+    {
+        return 1;
+    }
+
+    otf2::reader::reader rdr("otf2xx_raw_writer_trace/traces.otf2");
+    event_checker checker(rdr);
+    rdr.set_callback(checker);
+    rdr.read_definitions();
+    rdr.read_events();
+
+    if (checker.events != 22 || checker.enters != 10 || checker.leaves != 10 ||
+        checker.parameters != 2)
+    {
+        std::cerr << "Read " << checker.events << " events, " << checker.enters << " enters, "
+                  << checker.leaves << " leaves and " << checker.parameters << " parameters"
+                  << std::endl;
+        return 1;
+    }
+
+    if (checker.wrong_values)
+    {
+        std::cerr << "The values of the raw parameter events changed" << std::endl;
+        return 1;
+    }
+
+    if (checker.wrong_timestamps)
+    {
+        std::cerr << "The timestamps of the raw events changed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+
+#include <chrono>
+#include <iostream>
+
+// the writer test writes one event per nanosecond, starting at zero
+class correction_checker : public otf2::reader::callback
+{
+public:
+    explicit correction_checker(otf2::reader::reader& rdr) : rdr_(rdr)
+    {
+    }
+
+    void definition(const otf2::definition::location& loc) override
+    {
+        rdr_.register_location(loc);
+
+        // moves every event of the location five ticks, i.e. nanoseconds, into the future
+        rdr_.set_clock_correction(loc, otf2::chrono::clock_correction::linear(5));
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::enter& event) override
+    {
+        check(event.timestamp());
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::leave& event) override
+    {
+        check(event.timestamp());
+    }
+
+    std::uint64_t events = 0;
+    bool wrong_timestamps = false;
+
+private:
+    void check(otf2::chrono::time_point timestamp)
+    {
+        if (timestamp != otf2::chrono::time_point(std::chrono::nanoseconds(events + 5)))
+        {
+            std::cerr << "Event #" << events << " at " << timestamp << std::endl;
+            wrong_timestamps = true;
+        }
+
+        events++;
+    }
+
+    otf2::reader::reader& rdr_;
+};
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " path/to/trace.otf2" << std::endl;
+
+        return 1;
+    }
+
+    otf2::reader::reader rdr(argv[1]);
+    correction_checker checker(rdr);
+    rdr.set_callback(checker);
+    rdr.read_definitions();
+    rdr.read_events();
+
+    if (checker.events == 0 || checker.wrong_timestamps)
+    {
+        std::cerr << "The clock correction wasn't applied to the " << checker.events
+                  << " events" << std::endl;
+        return 1;
+    }
+}
@@ -99,3 +99,171 @@ TEST_CASE("Add and get strings")
         REQUIRE(!contains(refs, str.ref()));
     }
 }
+
+TEST_CASE("Take definitions out of a registry")
+{
+    otf2::registry reg;
+    auto str = reg.create<otf2::definition::string>("foo");
+    reg.create<otf2::definition::string>("bar");
+
+    auto taken = reg.take<otf2::definition::string>();
+    REQUIRE(taken.size() == 2);
+    REQUIRE(taken[str.ref()] == str);
+    REQUIRE(reg.all<otf2::definition::string>().data().size() == 0);
+
+    // taken references stay taken, but only as handles, which carry the reference
+    REQUIRE(reg.has<otf2::definition::string>(str.ref()));
+    const auto& handle = reg.get<otf2::definition::string>(str.ref());
+    REQUIRE(handle.ref() == str.ref());
+    REQUIRE(!handle.is_valid());
+    REQUIRE_THROWS_AS(reg.create<otf2::definition::string>(str.ref(), "foo"), otf2::exception);
+
+    // taken reference numbers aren't handed out again
+    auto other = reg.create<otf2::definition::string>("baz");
+    REQUIRE(!taken.count(other.ref()));
+}
+
+TEST_CASE("Definitions in an arena registry")
+{
+    otf2::definition::string escaped;
+    {
+        otf2::arena_registry reg;
+        const auto& pool = reg.allocation().get<otf2::definition::string>();
+
+        for (int i = 0; i < int(1e4); i++)
+        {
+            reg.create<otf2::definition::string>("Value" + std::to_string(i));
+        }
+        REQUIRE(pool.size() == 1e4);
+        REQUIRE(pool.capacity() >= pool.size());
+
+        auto& name = reg.create<otf2::definition::string>("main");
+        auto& region = reg.create<otf2::definition::region>(
+            name, name, name, otf2::common::role_type::function, otf2::common::paradigm_type::user,
+            otf2::common::flags_type::none, name, 0, 0);
+        REQUIRE(region.name() == name);
+        REQUIRE(reg.allocation().get<otf2::definition::region>().size() == 1);
+
+        SECTION("Unregistered definitions stay on the heap")
+        {
+            otf2::definition::string str(4711, "heap");
+            REQUIRE(pool.size() == 1e4 + 1);
+        }
+
+        escaped = reg.get<otf2::definition::string>(42);
+    }
+    REQUIRE(escaped.str() == "Value42");
+}
+
+TEST_CASE("Slab pools recycle released slots")
+{
+    otf2::definition::detail::slab_pool pool(sizeof(otf2::definition::detail::string_impl));
+    {
+        otf2::definition::detail::slab_scope scope(pool);
+        otf2::definition::string str(1, "temporary");
+        REQUIRE(pool.size() == 1);
+    }
+    REQUIRE(pool.size() == 0);
+
+    auto capacity = pool.capacity();
+    {
+        otf2::definition::detail::slab_scope scope(pool);
+        otf2::definition::string str(2, "recycled");
+        REQUIRE(pool.size() == 1);
+    }
+    REQUIRE(pool.capacity() == capacity);
+}
+
+TEST_CASE("Slab slots hold only the object")
+{
+    constexpr auto align = alignof(std::max_align_t);
+    constexpr auto slot_size =
+        (sizeof(otf2::definition::detail::string_impl) + align - 1) / align * align;
+
+    otf2::definition::detail::slab_pool pool(sizeof(otf2::definition::detail::string_impl));
+    otf2::definition::string heap(1, "heap");
+    {
+        otf2::definition::detail::slab_scope scope(pool);
+        otf2::definition::string pooled(2, "pooled");
+        // a slab only starts with a pointer to its storage
+        REQUIRE(pool.capacity() == (64 * 1024 - align) / slot_size);
+    }
+    REQUIRE(pool.size() == 0);
+}
+
+TEST_CASE("Slab scopes only take the first object of their pool's type")
+{
+    otf2::definition::detail::slab_pool pool(sizeof(otf2::definition::detail::string_impl));
+    otf2::definition::string name(1, "name");
+
+    otf2::definition::detail::slab_scope scope(pool);
+
+    otf2::definition::region region(1, name, name, name, otf2::common::role_type::function,
+                                    otf2::common::paradigm_type::user,
+                                    otf2::common::flags_type::none, name, 0, 0);
+    REQUIRE(pool.size() == 0);
+
+    otf2::definition::string first(2, "first");
+    otf2::definition::string second(3, "second");
+    REQUIRE(pool.size() == 1);
+}
+
+TEST_CASE("Group members and positions")
+{
+    otf2::registry reg;
+    auto& name = reg.create<otf2::definition::string>("group");
+
+    auto& group = reg.create<otf2::definition::regions_group>(
+        name, otf2::common::paradigm_type::user, otf2::common::group_flag_type::none);
+
+    std::vector<otf2::definition::region> regions;
+    for (int i = 0; i < 1000; i++)
+    {
+        regions.push_back(reg.create<otf2::definition::region>(
+            name, name, name, otf2::common::role_type::function, otf2::common::paradigm_type::user,
+            otf2::common::flags_type::none, name, 0, 0));
+    }
+
+    group.reserve(regions.size());
+    for (auto it = regions.rbegin(); it != regions.rend(); ++it)
+    {
+        group.add_member(*it);
+    }
+
+    REQUIRE(group.size() == regions.size());
+    REQUIRE(group.members().size() == regions.size());
+
+    for (std::size_t i = 0; i < regions.size(); i++)
+    {
+        const auto& region = regions[regions.size() - 1 - i];
+        REQUIRE(group.members()[i] == region.ref());
+        REQUIRE(group[i] == region);
+        REQUIRE(group[i].get() == region.get());
+        REQUIRE(group.contains(region));
+        REQUIRE(group.index_of(region) == i);
+        REQUIRE(group.index_of(group.members()[i]) == i);
+    }
+
+    SECTION("Remove a member")
+    {
+        group.remove_member(regions[500]);
+
+        REQUIRE(group.size() == regions.size() - 1);
+        REQUIRE(!group.contains(regions[500]));
+        REQUIRE_THROWS_AS(group.index_of(regions[500]), otf2::exception);
+        REQUIRE(group.index_of(regions[999]) == 0);
+        REQUIRE(group.index_of(regions[501]) == 498);
+        REQUIRE(group.index_of(regions[499]) == 499);
+        REQUIRE(group.index_of(regions[0]) == 998);
+    }
+
+    SECTION("Members are kept alive by the group")
+    {
+        otf2::definition::regions_group copy = group;
+        auto* impl = regions[0].get();
+        regions.clear();
+
+        REQUIRE(copy[999].get() == impl);
+        REQUIRE(copy[999].name().str() == "group");
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <otf2xx/event/reorder.hpp>
+#include <otf2xx/otf2.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace
+{
+struct collector : otf2::reader::callback
+{
+    using otf2::reader::callback::event;
+
+    void event(const otf2::definition::location& loc, const otf2::event::enter& evt) override
+    {
+        events.emplace_back(loc.ref().get(), evt.timestamp().time_since_epoch().count());
+    }
+
+    void event(const otf2::definition::location& loc, const otf2::event::leave& evt) override
+    {
+        events.emplace_back(loc.ref().get(), evt.timestamp().time_since_epoch().count());
+    }
+
+    std::vector<std::pair<std::uint64_t, std::int64_t>> events;
+};
+
+otf2::chrono::time_point tp(std::int64_t t)
+{
+    return otf2::chrono::time_point(otf2::chrono::duration(t));
+}
+} // namespace
+
+TEST_CASE("Reorder events by time")
+{
+    otf2::registry reg;
+
+    auto& root = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("host"), reg.create<otf2::definition::string>("node"));
+    auto& lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("process"),
+        otf2::definition::location_group::location_group_type::process, root);
+    auto& loc0 = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("thread 0"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+    auto& loc1 = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("thread 1"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto& name = reg.create<otf2::definition::string>("function");
+    auto& region = reg.create<otf2::definition::region>(
+        name, name, name, otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        name, 0, 0);
+
+    collector result;
+
+    SECTION("events within the window are sorted per location")
+    {
+        otf2::event::reorder stage(result, otf2::chrono::duration(10));
+
+        stage.event(loc0, otf2::event::enter(tp(5), region));
+        stage.event(loc0, otf2::event::leave(tp(3), region));
+        stage.event(loc1, otf2::event::enter(tp(100), region));
+        stage.event(loc0, otf2::event::enter(tp(8), region));
+
+        // nothing is older than the window yet
+        REQUIRE(result.events.empty());
+
+        stage.event(loc0, otf2::event::leave(tp(16), region));
+
+        // 3 and 5 are older than 16 by the window
+        REQUIRE(result.events.size() == 2);
+        REQUIRE(result.events[0].second == 3);
+        REQUIRE(result.events[1].second == 5);
+
+        stage.flush();
+
+        REQUIRE(result.events.size() == 5);
+        REQUIRE(result.events[2].second == 8);
+        REQUIRE(result.events[3].second == 16);
+        REQUIRE(result.events[4] == std::make_pair(loc1.ref().get(), std::int64_t(100)));
+        REQUIRE(stage.late_events() == 0);
+    }
+
+    SECTION("the number of held back events is bounded")
+    {
+        otf2::event::reorder stage(result, otf2::chrono::duration(1000), 2);
+
+        stage.event(loc0, otf2::event::enter(tp(3), region));
+        stage.event(loc0, otf2::event::enter(tp(1), region));
+        stage.event(loc0, otf2::event::enter(tp(2), region));
+
+        REQUIRE(result.events.size() == 1);
+        REQUIRE(result.events[0].second == 1);
+
+        stage.event(loc0, otf2::event::enter(tp(0), region));
+
+        // too late, it's passed on right away
+        REQUIRE(result.events.size() == 2);
+        REQUIRE(result.events[1].second == 0);
+        REQUIRE(stage.late_events() == 1);
+
+        stage.flush();
+
+        REQUIRE(result.events.size() == 4);
+        REQUIRE(result.events[2].second == 2);
+        REQUIRE(result.events[3].second == 3);
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/rewriter.hpp>
+
+#include <iostream>
+#include <string>
+
+// renames the strings, which keeps all references unchanged
+class renaming_rewriter : public otf2::writer::rewriter
+{
+public:
+    using otf2::writer::rewriter::rewriter;
+
+    void definition(const otf2::definition::string& def) override
+    {
+        write(otf2::definition::string(def.ref(), "renamed " + def.str()));
+    }
+};
+
+class counting_reader : public otf2::reader::callback
+{
+public:
+    void definition(const otf2::definition::region& def) override
+    {
+        renamed = renamed && def.name().str().rfind("renamed ", 0) == 0;
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::enter&) override
+    {
+        enters++;
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::leave&) override
+    {
+        leaves++;
+    }
+
+    bool renamed = true;
+    std::uint64_t enters = 0;
+    std::uint64_t leaves = 0;
+};
+
+counting_reader read(const std::string& path)
+{
+    counting_reader counter;
+
+    otf2::reader::reader rdr(path);
+    rdr.set_callback(counter);
+    rdr.read_definitions();
+    rdr.read_events();
+
+    return counter;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " path/to/trace.otf2" << std::endl;
+
+        return 1;
+    }
+
+    {
+        otf2::writer::archive ar("otf2xx_rewriter_definitions_trace", "traces");
+
+        renaming_rewriter rewriter(argv[1], ar);
+        rewriter.run_definitions_only();
+    }
+
+    auto input = read(argv[1]);
+    auto output = read("otf2xx_rewriter_definitions_trace/traces.otf2");
+
+    if (!output.renamed)
+    {
+        std::cerr << "The regions weren't renamed" << std::endl;
+        return 1;
+    }
+
+    if (output.enters != input.enters || output.leaves != input.leaves || input.enters == 0)
+    {
+        std::cerr << "Copied " << output.enters << " of " << input.enters << " enters and "
+                  << output.leaves << " of " << input.leaves << " leaves" << std::endl;
+        return 1;
+    }
+}
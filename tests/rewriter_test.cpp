@@ -0,0 +1,197 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/rewriter.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+class counting_rewriter : public otf2::writer::rewriter
+{
+public:
+    using otf2::writer::rewriter::rewriter;
+
+    void definition(const otf2::definition::location& loc) override
+    {
+        input_events += loc.num_events();
+        otf2::writer::rewriter::definition(loc);
+    }
+
+    void event(const otf2::definition::location& loc, const otf2::event::enter& event) override
+    {
+        enters++;
+        otf2::writer::rewriter::event(loc, event);
+    }
+
+    std::uint64_t input_events = 0;
+    std::atomic<std::uint64_t> enters{ 0 };
+};
+
+// counts the kinds of the enter and leave events of a trace
+class event_counter : public otf2::reader::callback
+{
+public:
+    explicit event_counter(otf2::reader::reader& rdr) : rdr_(rdr)
+    {
+    }
+
+    void definition(const otf2::definition::location& loc) override
+    {
+        rdr_.register_location(loc);
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::enter&) override
+    {
+        enters++;
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::leave&) override
+    {
+        leaves++;
+    }
+
+    void event(const otf2::definition::location&,
+               const otf2::event::calling_context_enter&) override
+    {
+        calling_context_enters++;
+    }
+
+    void event(const otf2::definition::location&,
+               const otf2::event::calling_context_leave&) override
+    {
+        calling_context_leaves++;
+    }
+
+    std::uint64_t enters = 0;
+    std::uint64_t leaves = 0;
+    std::uint64_t calling_context_enters = 0;
+    std::uint64_t calling_context_leaves = 0;
+
+private:
+    otf2::reader::reader& rdr_;
+};
+
+// writes a trace with a calling context enter and leave event
+void write_calling_context_trace(const std::string& path)
+{
+    otf2::writer::archive ar(path, "traces");
+
+    auto& reg = ar.registry();
+
+    auto& root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("host"), reg.create<otf2::definition::string>("node"));
+
+    auto& lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Sampled Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto& location = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("Sampled Thread"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto& name = reg.create<otf2::definition::string>("sampled");
+    auto& region = reg.create<otf2::definition::region>(
+        name, name, name, otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::sampling,
+        otf2::definition::region::flags_type::none, name, 0, 0);
+
+    auto& context = reg.create<otf2::definition::calling_context>(
+        region, otf2::definition::source_code_location());
+
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(2));
+
+    ar(location) << otf2::event::calling_context_enter(
+        otf2::chrono::time_point(std::chrono::nanoseconds(0)), context, 0);
+    ar(location) << otf2::event::calling_context_leave(
+        otf2::chrono::time_point(std::chrono::nanoseconds(1)), context);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " path/to/trace.otf2" << std::endl;
+
+        return 1;
+    }
+
+    otf2::writer::archive ar("otf2xx_rewriter_trace", "traces");
+
+    counting_rewriter rewriter(argv[1], ar);
+    rewriter.run(2);
+
+    std::uint64_t output_events = 0;
+    for (const auto& location : ar.registry().all<otf2::definition::location>())
+    {
+        output_events += location.num_events();
+    }
+
+    if (output_events != rewriter.input_events || rewriter.enters == 0)
+    {
+        std::cerr << "Rewrote " << output_events << " of " << rewriter.input_events << " events"
+                  << std::endl;
+        return 1;
+    }
+
+    // the default rewrite has to keep calling context events instead of turning them into enter
+    // and leave events
+    const std::string input = "otf2xx_rewriter_trace/calling_context_input";
+    write_calling_context_trace(input);
+
+    {
+        otf2::writer::archive calling_context_ar("otf2xx_rewriter_trace/calling_context",
+                                                 "traces");
+
+        otf2::writer::rewriter calling_context_rewriter(input + "/traces.otf2",
+                                                        calling_context_ar);
+        calling_context_rewriter.run();
+    }
+
+    otf2::reader::reader rdr("otf2xx_rewriter_trace/calling_context/traces.otf2");
+    event_counter counter(rdr);
+    rdr.set_callback(counter);
+    rdr.read_definitions();
+    rdr.read_events();
+
+    if (counter.calling_context_enters != 1 || counter.calling_context_leaves != 1 ||
+        counter.enters != 0 || counter.leaves != 0)
+    {
+        std::cerr << "Rewrote the calling context events to " << counter.enters << " enter and "
+                  << counter.leaves << " leave events" << std::endl;
+        return 1;
+    }
+}
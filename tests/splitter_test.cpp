@@ -0,0 +1,204 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/splitter.hpp>
+
+#include <iostream>
+#include <string>
+
+class stack_checker : public otf2::reader::callback
+{
+public:
+    void definition(const otf2::definition::location& loc) override
+    {
+        events += loc.num_events();
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::enter&) override
+    {
+        enters++;
+        depth++;
+    }
+
+    void event(const otf2::definition::location&, const otf2::event::leave&) override
+    {
+        leave();
+    }
+
+    void event(const otf2::definition::location&,
+               const otf2::event::calling_context_enter&) override
+    {
+        calling_context_enters++;
+        depth++;
+    }
+
+    void event(const otf2::definition::location&,
+               const otf2::event::calling_context_leave&) override
+    {
+        leave();
+    }
+
+    std::uint64_t events = 0;
+    std::uint64_t enters = 0;
+    std::uint64_t calling_context_enters = 0;
+    std::uint64_t depth = 0;
+    bool unbalanced = false;
+
+private:
+    void leave()
+    {
+        if (depth-- == 0)
+        {
+            unbalanced = true;
+        }
+    }
+};
+
+stack_checker check(const std::string& path)
+{
+    stack_checker checker;
+
+    otf2::reader::reader rdr(path);
+    rdr.set_callback(checker);
+    rdr.read_definitions();
+    rdr.read_events();
+
+    return checker;
+}
+
+// writes a trace, which stays in a calling context across the boundary of the slices
+void write_calling_context_trace(const std::string& path)
+{
+    otf2::writer::archive ar(path, "traces");
+
+    auto& reg = ar.registry();
+
+    auto& root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("host"), reg.create<otf2::definition::string>("node"));
+
+    auto& lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Sampled Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto& location = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("Sampled Thread"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto& name = reg.create<otf2::definition::string>("sampled");
+    auto& region = reg.create<otf2::definition::region>(
+        name, name, name, otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::sampling,
+        otf2::definition::region::flags_type::none, name, 0, 0);
+
+    auto& context = reg.create<otf2::definition::calling_context>(
+        region, otf2::definition::source_code_location());
+
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(20));
+
+    ar(location) << otf2::event::calling_context_enter(
+        otf2::chrono::time_point(std::chrono::nanoseconds(0)), context, 0);
+    ar(location) << otf2::event::calling_context_leave(
+        otf2::chrono::time_point(std::chrono::nanoseconds(15)), context);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " path/to/trace.otf2" << std::endl;
+
+        return 1;
+    }
+
+    auto input = check(argv[1]);
+
+    // the writer test enters ten regions in the first ten nanoseconds
+    otf2::writer::splitter splitter(argv[1], "otf2xx_splitter_trace", "traces",
+                                    std::chrono::nanoseconds(10));
+    splitter.run(2);
+
+    if (splitter.num_slices() != 2)
+    {
+        std::cerr << "Split the trace into " << splitter.num_slices() << " slices" << std::endl;
+        return 1;
+    }
+
+    std::uint64_t events = 0;
+    for (std::size_t i = 0; i < splitter.num_slices(); ++i)
+    {
+        auto slice = check("otf2xx_splitter_trace_" + std::to_string(i) + "/traces.otf2");
+
+        if (slice.unbalanced || slice.depth != 0)
+        {
+            std::cerr << "The stack of slice " << i << " isn't balanced" << std::endl;
+            return 1;
+        }
+
+        events += slice.events;
+    }
+
+    // the regions entered at the boundary are left and entered again
+    if (events != input.events + 20)
+    {
+        std::cerr << "Wrote " << events << " events for " << input.events << " events"
+                  << std::endl;
+        return 1;
+    }
+
+    // the calling context is left and entered again at the boundary through the calling context
+    const std::string calling_context_path = "otf2xx_splitter_trace_calling_context";
+    write_calling_context_trace(calling_context_path + "/input");
+
+    otf2::writer::splitter calling_context_splitter(calling_context_path + "/input/traces.otf2",
+                                                    calling_context_path + "/slice", "traces",
+                                                    std::chrono::nanoseconds(10));
+    calling_context_splitter.run();
+
+    for (std::size_t i = 0; i < calling_context_splitter.num_slices(); ++i)
+    {
+        auto slice =
+            check(calling_context_path + "/slice_" + std::to_string(i) + "/traces.otf2");
+
+        if (slice.unbalanced || slice.depth != 0 || slice.enters != 0 ||
+            slice.calling_context_enters != 1)
+        {
+            std::cerr << "Slice " << i << " has " << slice.enters << " enter and "
+                      << slice.calling_context_enters << " calling context enter events"
+                      << std::endl;
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,163 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+std::chrono::high_resolution_clock::time_point get_time(void)
+{
+    static std::size_t count = 0;
+    return std::chrono::high_resolution_clock::time_point(
+        std::chrono::high_resolution_clock::duration(count++));
+}
+
+class metric_counter : public otf2::reader::callback
+{
+public:
+    void event(const otf2::definition::location&, const otf2::event::metric& metric) override
+    {
+        if (metric.raw_values().size() == 4)
+        {
+            events = metric.raw_values()[0].as_uint64();
+        }
+        metrics++;
+    }
+
+    std::uint64_t metrics = 0;
+    std::uint64_t events = 0;
+};
+
+bool write_trace()
+{
+    otf2::writer::archive ar("otf2xx_statistics_trace", "traces");
+
+    auto& reg = ar().registry();
+
+    ar.enable_statistics(otf2::writer::statistics::make_metrics(reg));
+
+    auto root_node = reg.create<otf2::definition::system_tree_node>(
+        reg.create<otf2::definition::string>("MyHost"),
+        reg.create<otf2::definition::string>("node"));
+
+    auto lg = reg.create<otf2::definition::location_group>(
+        reg.create<otf2::definition::string>("Master Process"),
+        otf2::definition::location_group::location_group_type::process, root_node);
+
+    auto location = reg.create<otf2::definition::location>(
+        reg.create<otf2::definition::string>("MainThread"), lg,
+        otf2::definition::location::location_type::cpu_thread);
+
+    auto empty = reg.create<otf2::definition::string>("");
+    auto region = reg.create<otf2::definition::region>(
+        reg.create<otf2::definition::string>("MyFunction"), empty, empty,
+        otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        empty, 0, 0);
+
+    ar << otf2::definition::clock_properties(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0),
+                                             otf2::chrono::ticks(100));
+
+    auto& arl = ar(location);
+
+    for (int i = 0; i < 10; ++i)
+        arl << otf2::event::enter(otf2::chrono::convert_time_point(get_time()), region);
+
+    for (int i = 0; i < 10; ++i)
+        arl << otf2::event::leave(otf2::chrono::convert_time_point(get_time()), region);
+
+    std::vector<otf2::chrono::time_point> timestamps;
+    std::vector<OTF2_RegionRef> regions(10, region.ref());
+
+    for (int i = 0; i < 10; ++i)
+        timestamps.push_back(otf2::chrono::convert_time_point(get_time()));
+    arl.write_enters(timestamps.data(), regions.data(), timestamps.size());
+
+    otf2::chrono::convert to_ticks(otf2::chrono::ticks(1e9), otf2::chrono::ticks(0));
+    auto raw = arl.raw();
+    for (int i = 0; i < 10; ++i)
+        raw.leave(to_ticks(otf2::chrono::convert_time_point(get_time())).count(), region.ref());
+
+    auto stats = ar.statistics(location);
+
+    if (stats.events<otf2::event::enter>() != 20 || stats.events<otf2::event::leave>() != 20 ||
+        stats.events() != 40)
+    {
+        std::cerr << "Counted " << stats.events<otf2::event::enter>() << " enters and "
+                  << stats.events<otf2::event::leave>() << " leaves" << std::endl;
+        return false;
+    }
+
+    if (stats.write_time().count() <= 0)
+    {
+        std::cerr << "Didn't measure the time of the writes" << std::endl;
+        return false;
+    }
+
+    // the counters of closed writers are kept
+    ar.close_local_writer(location);
+
+    if (ar.statistics().events() != 40)
+    {
+        std::cerr << "Counted " << ar.statistics().events() << " events after closing"
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    if (!write_trace())
+    {
+        return 1;
+    }
+
+    metric_counter counter;
+
+    otf2::reader::reader rdr("otf2xx_statistics_trace/traces.otf2");
+    rdr.set_callback(counter);
+    rdr.read_definitions();
+    rdr.read_events();
+
+    if (counter.metrics != 1 || counter.events != 40)
+    {
+        std::cerr << "Read " << counter.metrics << " statistics metrics with " << counter.events
+                  << " events" << std::endl;
+        return 1;
+    }
+}
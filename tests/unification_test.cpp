@@ -0,0 +1,169 @@
+/*
+ * This file is part of otf2xx (https://github.com/tud-zih-energy/otf2xx)
+ * otf2xx - A wrapper for the Open Trace Format 2 library
+ *
+ * Copyright (c) 2013-2016, Technische Universität Dresden, Germany
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <otf2xx/otf2.hpp>
+#include <otf2xx/writer/unification.hpp>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int check(int rank, int size)
+{
+    otf2::registry reg;
+
+    // every rank defines its strings in a different order, so the local references differ
+    auto& own = reg.create<otf2::definition::string>("rank " + std::to_string(rank));
+    auto& kind = reg.create<otf2::definition::string>("kind " + std::to_string(rank % 2));
+    auto& common = reg.create<otf2::definition::string>("common");
+    // a sparse reference, which must not blow up the mapping table
+    auto& main_name = reg.create<otf2::definition::string>(1 << 24, "main");
+
+    auto make_region = [&reg, &common](const otf2::definition::string& name) -> auto&
+    {
+        return reg.create<otf2::definition::region>(
+            name, name, common, otf2::definition::region::role_type::function,
+            otf2::definition::region::paradigm_type::user,
+            otf2::definition::region::flags_type::none, common, 0, 0);
+    };
+
+    if (rank % 2)
+    {
+        make_region(kind);
+    }
+    // the main region has no source file
+    auto& main_region = reg.create<otf2::definition::region>(
+        main_name, main_name, common, otf2::definition::region::role_type::function,
+        otf2::definition::region::paradigm_type::user, otf2::definition::region::flags_type::none,
+        otf2::definition::string(), 0, 0);
+    if (rank % 2 == 0)
+    {
+        make_region(kind);
+    }
+
+    otf2::writer::unification unification(MPI_COMM_WORLD);
+    unification.unify(reg);
+
+    // the definitions with the same content got the same global reference on all ranks
+    std::uint32_t common_ref = unification.global_ref(common);
+    std::uint32_t main_ref = unification.global_ref(main_region);
+    std::uint32_t own_ref = unification.global_ref(own);
+
+    std::uint32_t min_refs[2], max_refs[2], refs[2] = { common_ref, main_ref };
+    MPI_Allreduce(refs, min_refs, 2, MPI_UINT32_T, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(refs, max_refs, 2, MPI_UINT32_T, MPI_MAX, MPI_COMM_WORLD);
+
+    std::vector<std::uint32_t> own_refs(size);
+    MPI_Gather(&own_ref, 1, MPI_UINT32_T, own_refs.data(), 1, MPI_UINT32_T, 0, MPI_COMM_WORLD);
+
+    if (min_refs[0] != max_refs[0] || min_refs[1] != max_refs[1])
+    {
+        std::cerr << "Rank " << rank << " got different references for the same definitions"
+                  << std::endl;
+        return 1;
+    }
+
+    if (rank != 0)
+    {
+        return 0;
+    }
+
+    // the unified references would collide with the ones of the local definitions
+    try
+    {
+        unification.write_definitions(reg);
+
+        std::cerr << "Wrote the unified definitions over existing ones" << std::endl;
+        return 1;
+    }
+    catch (const otf2::exception&)
+    {
+    }
+
+    otf2::registry global;
+    unification.write_definitions(global);
+
+    std::size_t kinds = std::min(size, 2);
+
+    if (global.all<otf2::definition::string>().data().size() != 2 + kinds + size ||
+        global.all<otf2::definition::region>().data().size() != 1 + kinds)
+    {
+        std::cerr << "Unified to " << global.all<otf2::definition::string>().data().size()
+                  << " strings and " << global.all<otf2::definition::region>().data().size()
+                  << " regions" << std::endl;
+        return 1;
+    }
+
+    for (int i = 0; i < size; i++)
+    {
+        if (global.get<otf2::definition::string>(own_refs[i]).str() !=
+            "rank " + std::to_string(i))
+        {
+            std::cerr << "The string of rank " << i << " was mapped to '"
+                      << global.get<otf2::definition::string>(own_refs[i]) << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    const auto& global_main = global.get<otf2::definition::region>(main_ref);
+    if (global_main.name().str() != "main" ||
+        global_main.source_file().ref() != otf2::definition::string::reference_type::undefined())
+    {
+        std::cerr << "The main region was mapped to the wrong region" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    int result = check(rank, size);
+
+    int failed;
+    MPI_Allreduce(&result, &failed, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+    MPI_Finalize();
+
+    return failed;
+}